@@ -0,0 +1,83 @@
+#!/bin/bash
+
+#######################################################################
+### Builds the terminal engine for the host as libxwterm-core,      ###
+### without SDL or OpenGL ES, the xwterm-headless driver and the    ###
+### xwterm-daemon session server.                                   ###
+### ./buildit_core.sh [debug]                                       ###
+#######################################################################
+
+#######################################################################
+### List the core source files here                                 ###
+#######################################################################
+export SRC="terminal/headlessterminal.cpp terminal/seqparser.cpp terminal/ptybackend.cpp terminal/epollbackend.cpp terminal/uringbackend.cpp terminal/session.cpp terminal/sessionclient.cpp terminal/sessionrecorder.cpp terminal/sessionmanager.cpp terminal/sessionserver.cpp terminal/terminal.cpp terminal/recordingreader.cpp terminal/recordingplayer.cpp terminal/screendelta.cpp terminal/scrollbackindex.cpp terminal/scrollbacksearch.cpp terminal/terminalsnapshot.cpp terminal/terminalstate.cpp terminal/vtterminalstate.cpp util/databuffer.cpp util/logger.cpp util/point.cpp util/ringbuffer.cpp"
+
+#######################################################################
+### List the libraries needed.                                      ###
+#######################################################################
+export LIBS="-lpthread"
+
+#######################################################################
+### Name your output library, and the executables with their main  ###
+### OUTFILES="<executable>:<source> ..."                            ###
+#######################################################################
+export LIBNAME="libxwterm-core"
+export OUTFILES="xwterm-headless:headlessmain.cpp xwterm-daemon:daemonmain.cpp"
+
+#######################################################################
+### Extra compiler flags                                            ###
+#######################################################################
+export MYCPPFLAGS=" -I../plugin/"
+
+
+###################################
+######## Do not edit below ########
+###################################
+
+if [ ! "$CXX" ];then
+	CXX="g++"
+fi
+
+if [ "$1" == "debug" ]; then
+	OPTS="-g -O0"
+else
+	OPTS="-O2"
+fi
+
+CPPFLAGS="-std=gnu++98 -fPIC"${MYCPPFLAGS}
+
+#Builds the io_uring backend if the kernel headers have it. It calls the kernel directly.
+if echo "#include <linux/io_uring.h>" | $CXX -E -x c++ - > /dev/null 2>&1; then
+	CPPFLAGS="${CPPFLAGS} -DUSE_IO_URING"
+fi
+
+export BUILDDIR="Build_Core"
+SRCDIR="../plugin"
+
+if [ -e "$BUILDDIR" ]; then
+	rm -rf "$BUILDDIR"
+fi
+mkdir -p $BUILDDIR/obj
+
+echo "Building core for host"
+OBJS=""
+for i in $SRC
+do
+	OBJ=$BUILDDIR/obj/$(echo $i | tr '/' '_' | sed 's/\.cpp$/.o/')
+	echo "$CXX $OPTS $CPPFLAGS -c -o $OBJ $SRCDIR/$i"
+	$CXX $OPTS $CPPFLAGS -c -o $OBJ $SRCDIR/$i || exit 1
+	OBJS=${OBJS}$OBJ" "
+done
+
+ar rcs $BUILDDIR/$LIBNAME.a $OBJS || exit 1
+$CXX -shared -o $BUILDDIR/$LIBNAME.so $OBJS $LIBS || exit 1
+
+for i in $OUTFILES
+do
+	OUTFILE=${i%%:*}
+	MAIN=${i#*:}
+	echo "$CXX $OPTS $CPPFLAGS -o $BUILDDIR/$OUTFILE $SRCDIR/$MAIN $BUILDDIR/$LIBNAME.a $LIBS"
+	$CXX $OPTS $CPPFLAGS -o $BUILDDIR/$OUTFILE $SRCDIR/$MAIN $BUILDDIR/$LIBNAME.a $LIBS || exit 1
+done
+
+echo -e "\nPutting $LIBNAME and the executables into $BUILDDIR.\n"
@@ -4,7 +4,7 @@
 ### List your source files here                                     ###
 ### SRC="<source1> <source2>"                                       ###
 #######################################################################
-export SRC="terminalmain.cpp sdl/sdlcore.cpp sdl/sdlterminal.cpp terminal/seqparser.cpp terminal/terminalconfigmanager.cpp terminal/terminal.cpp terminal/terminalstate.cpp terminal/vtterminalstate.cpp util/configmanager.cpp util/databuffer.cpp util/logger.cpp util/point.cpp"
+export SRC="terminalmain.cpp sdl/sdlcore.cpp sdl/sdlterminal.cpp terminal/seqparser.cpp terminal/terminalconfigmanager.cpp terminal/ptybackend.cpp terminal/epollbackend.cpp terminal/uringbackend.cpp terminal/session.cpp terminal/sessionclient.cpp terminal/sessionrecorder.cpp terminal/sessionmanager.cpp terminal/sessionserver.cpp terminal/terminal.cpp terminal/screendelta.cpp terminal/scrollbackindex.cpp terminal/scrollbacksearch.cpp terminal/terminalsnapshot.cpp terminal/terminalstate.cpp terminal/vtterminalstate.cpp util/configmanager.cpp util/databuffer.cpp util/logger.cpp util/point.cpp util/ringbuffer.cpp"
 
 #######################################################################
 ### List the libraries needed.                                      ###
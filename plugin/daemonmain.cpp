@@ -0,0 +1,93 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "terminal/sessionserver.hpp"
+#include "util/logger.hpp"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+void printUsage()
+{
+	printf("Usage: xwterm-daemon [-f] [-p <count>] [-s <socket>] [command [args...]]\n");
+	printf("Keeps terminal sessions running for front ends to attach to and detach from.\n");
+	printf("  -f  Stays in the foreground.\n");
+	printf("  -p  Number of idle sessions kept ready for new clients. Default 0.\n");
+	printf("  -s  Socket to listen on. Default %s.\n", SessionServer::getDefaultPath());
+	printf("New sessions run the command, or log in if there is none.\n");
+}
+
+int main(int argc, char **argv)
+{
+	SessionServer server;
+	const char *sPath = SessionServer::getDefaultPath();
+	bool bForeground = false;
+	int nPoolSize = 0;
+	sigset_t signals;
+	int nSignal;
+	int opt;
+
+	Logger::getInstance()->setOutputStream(stderr);
+
+	//Stops at the command, so its own options are left alone.
+	while ((opt = getopt(argc, argv, "+fp:s:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'f':
+			bForeground = true;
+			break;
+		case 'p':
+			nPoolSize = atoi(optarg);
+			break;
+		case 's':
+			sPath = optarg;
+			break;
+		default:
+			printUsage();
+			return 1;
+		}
+	}
+
+	//Threads do not survive the fork, so this comes before the server starts.
+	if (!bForeground && daemon(0, 0) != 0)
+	{
+		perror("Cannot run in the background");
+		return 1;
+	}
+
+	//Every thread inherits the mask, so the signals are only taken below.
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	if (server.start(sPath, (optind < argc) ? argv + optind : NULL, nPoolSize) != 0)
+	{
+		return 1;
+	}
+
+	sigwait(&signals, &nSignal);
+
+	server.stop();
+
+	return 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "terminal/headlessterminal.hpp"
+#include "util/logger.hpp"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+static const int DEFAULT_WIDTH = 80;
+static const int DEFAULT_HEIGHT = 24;
+static const int DEFAULT_IDLE_MSEC = 200;
+static const int DEFAULT_TIMEOUT_SEC = 10;
+
+/**
+ * Decodes the escapes \n, \r, \t, \e, \\ and \xHH in the given input.
+ */
+static std::string decodeInput(const char *sInput)
+{
+	std::string input;
+
+	for (const char *c = sInput; *c != '\0'; c++)
+	{
+		if (*c != '\\' || c[1] == '\0')
+		{
+			input.append(1, *c);
+			continue;
+		}
+
+		c++;
+
+		switch (*c)
+		{
+		case 'n':
+			input.append(1, '\n');
+			break;
+		case 'r':
+			input.append(1, '\r');
+			break;
+		case 't':
+			input.append(1, '\t');
+			break;
+		case 'e':
+			input.append(1, '\x1B');
+			break;
+		case 'x':
+			if (isxdigit((unsigned char)c[1]) && isxdigit((unsigned char)c[2]))
+			{
+				char sHex[3] = { c[1], c[2], '\0' };
+
+				input.append(1, (char)strtol(sHex, NULL, 16));
+				c += 2;
+				break;
+			}
+			//Not an escape. Keep it as it is.
+			input.append(1, '\\');
+			input.append(1, *c);
+			break;
+		case '\\':
+			input.append(1, '\\');
+			break;
+		default:
+			input.append(1, '\\');
+			input.append(1, *c);
+			break;
+		}
+	}
+
+	return input;
+}
+
+void printUsage()
+{
+	printf("Usage: xwterm-headless [-s <width>x<height>] [-i <input>]... [-w <msec>] [-t <seconds>] [-x] [-r <file>] [-q]\n");
+	printf("                       [-a <socket> [-n <session>] [-d] | command [args...]]\n");
+	printf("Runs a command in a terminal without a display and prints the screen once it is done.\n");
+	printf("  -s  Screen size. Default %dx%d.\n", DEFAULT_WIDTH, DEFAULT_HEIGHT);
+	printf("  -i  Input to type once the output settles. Understands \\n, \\r, \\t, \\e and \\xHH. Can be repeated.\n");
+	printf("  -w  Output is settled after this long without any. Default %d.\n", DEFAULT_IDLE_MSEC);
+	printf("  -t  Gives up after this long. Default %d.\n", DEFAULT_TIMEOUT_SEC);
+	printf("  -x  Waits for the command to exit instead of for the output to settle, and exits with its exit code.\n");
+	printf("  -r  Records the session to a binary log.\n");
+	printf("  -q  Does not print the screen.\n");
+	printf("  -a  Attaches to a session of the daemon listening on the socket instead of running a command.\n");
+	printf("  -n  Session of the daemon to attach to. Default is a new one.\n");
+	printf("  -d  Follows the screen of the daemon session by screen deltas instead of its output.\n");
+	printf("The command defaults to $SHELL. Exits with 2 if it timed out.\n");
+}
+
+int main(int argc, char **argv)
+{
+	HeadlessTerminal terminal;
+	int nWidth = DEFAULT_WIDTH;
+	int nHeight = DEFAULT_HEIGHT;
+	int nIdleMsec = DEFAULT_IDLE_MSEC;
+	int nTimeoutMsec = DEFAULT_TIMEOUT_SEC * 1000;
+	bool bWaitForExit = false;
+	bool bQuiet = false;
+	const char *sRecordFile = NULL;
+	const char *sSocket = NULL;
+	int nSession = -1;
+	bool bDelta = false;
+	std::vector<std::string> inputs;
+	std::vector<const char *> command;
+	std::string text;
+	int nResult;
+	int nStatus = -1;
+	int opt;
+
+	Logger::getInstance()->setOutputStream(stderr);
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	//Stops at the command, so its own options are left alone.
+	while ((opt = getopt(argc, argv, "+s:i:w:t:xr:qa:n:dh")) != -1)
+	{
+		switch (opt)
+		{
+		case 's':
+			if (sscanf(optarg, "%dx%d", &nWidth, &nHeight) != 2 || nWidth < 1 || nHeight < 1)
+			{
+				printUsage();
+				return 1;
+			}
+			break;
+		case 'i':
+			inputs.push_back(decodeInput(optarg));
+			break;
+		case 'w':
+			nIdleMsec = atoi(optarg);
+			break;
+		case 't':
+			nTimeoutMsec = (int)(atof(optarg) * 1000);
+			break;
+		case 'x':
+			bWaitForExit = true;
+			break;
+		case 'r':
+			sRecordFile = optarg;
+			break;
+		case 'q':
+			bQuiet = true;
+			break;
+		case 'a':
+			sSocket = optarg;
+			break;
+		case 'n':
+			nSession = atoi(optarg);
+			break;
+		case 'd':
+			bDelta = true;
+			break;
+		default:
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (optind < argc)
+	{
+		command.assign(argv + optind, argv + argc);
+	}
+	else
+	{
+		command.push_back((getenv("SHELL") != NULL) ? getenv("SHELL") : "/bin/sh");
+	}
+
+	command.push_back(NULL);
+
+	if (sSocket != NULL)
+	{
+		if (terminal.attach(sSocket, nSession, nWidth, nHeight, bDelta) != 0)
+		{
+			fprintf(stderr, "Cannot attach to %s\n", sSocket);
+			return 1;
+		}
+	}
+	else if (terminal.start(nWidth, nHeight, &command[0]) != 0)
+	{
+		fprintf(stderr, "Cannot start %s\n", command[0]);
+		return 1;
+	}
+
+	if (sRecordFile != NULL && terminal.getSession() == NULL)
+	{
+		fprintf(stderr, "Only sessions run here can be recorded\n");
+	}
+	else if (sRecordFile != NULL && terminal.getSession()->startRecording(sRecordFile, SR_FORMAT_BINARY) != 0)
+	{
+		fprintf(stderr, "Cannot record to %s\n", sRecordFile);
+	}
+
+	nResult = terminal.waitUntilSettled(nIdleMsec, nTimeoutMsec);
+
+	for (size_t i = 0; i < inputs.size() && nResult == 0; i++)
+	{
+		terminal.sendInput(inputs[i].data(), inputs[i].size());
+		nResult = terminal.waitUntilSettled(nIdleMsec, nTimeoutMsec);
+	}
+
+	if (bWaitForExit && nResult == 0)
+	{
+		nResult = terminal.waitUntilSettled(-1, nTimeoutMsec);
+	}
+
+	if (!bQuiet)
+	{
+		terminal.getScreenText(text);
+		fwrite(text.data(), 1, text.size(), stdout);
+	}
+
+	if (bWaitForExit && nResult == 1)
+	{
+		nStatus = terminal.getExitStatus();
+	}
+
+	terminal.stop();
+
+	if (nResult < 0)
+	{
+		return 2;
+	}
+	else if (nStatus != -1 && WIFEXITED(nStatus))
+	{
+		return WEXITSTATUS(nStatus);
+	}
+	else if (nStatus != -1 && WIFSIGNALED(nStatus))
+	{
+		return 128 + WTERMSIG(nStatus);
+	}
+
+	return 0;
+}
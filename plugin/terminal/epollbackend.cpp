@@ -0,0 +1,195 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "epollbackend.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "sessionmanager.hpp"
+#include "terminal.hpp"
+#include "util/logger.hpp"
+
+const int EpollBackend::MAX_EVENTS = 16;
+const uintptr_t EpollBackend::EXIT_TAG = 1;
+
+EpollBackend::EpollBackend(SessionManager *manager) : PTYBackend(manager)
+{
+	m_epollFD = -1;
+}
+
+EpollBackend::~EpollBackend()
+{
+	if (m_epollFD >= 0)
+	{
+		close(m_epollFD);
+	}
+}
+
+const char *EpollBackend::getName()
+{
+	return "epoll";
+}
+
+/**
+ * Creates the epoll set and watches the wake up event.
+ * Returns 0 if success.
+ */
+int EpollBackend::init()
+{
+	struct epoll_event event;
+
+	m_epollFD = epoll_create(MAX_EVENTS);
+
+	if (m_epollFD < 0 || createWakeEvent() != 0)
+	{
+		Logger::getInstance()->error("Cannot create reader events.");
+		return -1;
+	}
+
+	//Keep the descriptor out of child processes.
+	fcntl(m_epollFD, F_SETFD, FD_CLOEXEC);
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+
+	if (epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_wakeFD, &event) < 0)
+	{
+		Logger::getInstance()->error("Cannot watch reader wake up event.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Adds, changes or removes a descriptor in the epoll set. A descriptor is left out of epoll
+ * altogether when no events are wanted, since a hung up master would otherwise keep waking
+ * the reader.
+ * Returns 0 if success.
+ */
+int EpollBackend::watch(int nFD, int nOldEvents, int nEvents, void *data)
+{
+	struct epoll_event event;
+	int op;
+
+	if (nEvents == nOldEvents)
+	{
+		return 0;
+	}
+
+	memset(&event, 0, sizeof(event));
+	event.events = (((nEvents & (PB_READ | PB_EXIT)) != 0) ? EPOLLIN : 0) | (((nEvents & PB_WRITE) != 0) ? EPOLLOUT : 0);
+	event.data.ptr = data;
+
+	if (nOldEvents == 0)
+	{
+		op = EPOLL_CTL_ADD;
+	}
+	else if (nEvents == 0)
+	{
+		op = EPOLL_CTL_DEL;
+	}
+	else
+	{
+		op = EPOLL_CTL_MOD;
+	}
+
+	return epoll_ctl(m_epollFD, op, nFD, &event);
+}
+
+/**
+ * Changes the events watched on the master, and on the pidfd of the child for exiting. The
+ * pidfd is told apart from the master by the lowest bit of the terminal pointer.
+ * Returns 0 if success.
+ */
+int EpollBackend::setEvents(Terminal *terminal, int nEvents)
+{
+	int nOldEvents = terminal->m_nMasterEvents;
+
+	if (watch(terminal->m_masterFD, nOldEvents & ~PB_EXIT, nEvents & ~PB_EXIT, terminal) < 0
+		|| watch(terminal->m_pidFD, nOldEvents & PB_EXIT, nEvents & PB_EXIT, (char *)terminal + EXIT_TAG) < 0)
+	{
+		Logger::getInstance()->error("Cannot watch master pseudo-terminal.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * The epoll set holds no memory of the terminals, so a terminal can go as soon as the
+ * reader thread is done with it.
+ */
+bool EpollBackend::isBusy(Terminal *terminal)
+{
+	return false;
+}
+
+/**
+ * Waits for output from all the child processes. The thread sleeps in epoll until a master
+ * is ready or the reader is woken up, so idle sessions use no CPU.
+ */
+int EpollBackend::run()
+{
+	struct epoll_event events[MAX_EVENTS];
+	int nNumEvents;
+	int result = 0;
+
+	while (!m_manager->isDone())
+	{
+		nNumEvents = epoll_wait(m_epollFD, events, MAX_EVENTS, -1);
+
+		if (nNumEvents < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			Logger::getInstance()->error("Cannot wait for pseudo terminals.");
+			result = -1;
+			break;
+		}
+
+		for (int i = 0; i < nNumEvents && !m_manager->isDone(); i++)
+		{
+			if (events[i].data.ptr == NULL)
+			{
+				drainWakeEvent();
+				m_manager->handleWake();
+			}
+			else if (((uintptr_t)events[i].data.ptr & EXIT_TAG) != 0)
+			{
+				m_manager->handleEvents((Terminal *)((char *)events[i].data.ptr - EXIT_TAG), PB_EXIT);
+			}
+			else
+			{
+				m_manager->handleEvents((Terminal *)events[i].data.ptr,
+					(((events[i].events & EPOLLOUT) != 0) ? PB_WRITE : 0) | (((events[i].events & ~EPOLLOUT) != 0) ? PB_READ : 0));
+			}
+		}
+	}
+
+	return result;
+}
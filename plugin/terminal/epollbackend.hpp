@@ -0,0 +1,52 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPOLLBACKEND_HPP__
+#define EPOLLBACKEND_HPP__
+
+#include <stdint.h>
+
+#include "ptybackend.hpp"
+
+/**
+ * Waits for the masters to be readable or writable with epoll, and reads and writes
+ * them without blocking. Works on any kernel the terminal runs on. The children are
+ * waited for in the same epoll set through their pidfds.
+ */
+class EpollBackend : public PTYBackend
+{
+private:
+	static const int MAX_EVENTS;
+	static const uintptr_t EXIT_TAG;
+
+	int m_epollFD;
+
+	int watch(int nFD, int nOldEvents, int nEvents, void *data);
+
+public:
+	EpollBackend(SessionManager *manager);
+	~EpollBackend();
+
+	const char *getName();
+	int init();
+	int setEvents(Terminal *terminal, int nEvents);
+	bool isBusy(Terminal *terminal);
+	int run();
+};
+
+#endif
@@ -1,76 +1,118 @@
-/**
- * This file is part of SDLTerminal.
- * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
- *
- * SDLTerminal is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * SDLTerminal is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
-
- * You should have received a copy of the GNU General Public License
- * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef EXTTERMINAL_HPP__
-#define EXTTERMINAL_HPP__
-
-#include <stdio.h>
-
-/**
- * Interface for external terminals to transfer data.
- */
-class ExtTerminal
-{
-private:
-	bool m_bExtTerminalReady;
-
-public:
-	ExtTerminal()
-	{
-		m_bExtTerminalReady = false;
-	}
-
-	/**
-	 * Insert data into this terminal.
-	 */
-	virtual void insertData(const char *data, size_t size) {}
-
-	bool isReady()
-	{
-		return m_bExtTerminalReady;
-	}
-
-	void setReady(bool bReady)
-	{
-		m_bExtTerminalReady = bReady;
-	}
-};
-
-class ExtTerminalContainer
-{
-private:
-	ExtTerminal *m_extTerminal;
-
-public:
-	ExtTerminalContainer()
-	{
-		m_extTerminal = NULL;
-	}
-
-	void setExtTerminal(ExtTerminal *extTerminal)
-	{
-		m_extTerminal = extTerminal;
-	}
-
-	ExtTerminal *getExtTerminal()
-	{
-		return m_extTerminal;
-	}
-};
-
-#endif
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXTTERMINAL_HPP__
+#define EXTTERMINAL_HPP__
+
+#include <stdio.h>
+
+/**
+ * Interface for external terminals to transfer data.
+ */
+class ExtTerminal
+{
+private:
+	bool m_bExtTerminalReady;
+
+public:
+	ExtTerminal()
+	{
+		m_bExtTerminalReady = false;
+	}
+
+	/**
+	 * Insert data into this terminal. The data is not null terminated and may contain
+	 * null characters; only the given size is valid.
+	 */
+	virtual void insertData(const char *data, size_t size) {}
+
+	/**
+	 * Pastes data into this terminal, surrounded by the bracketed paste markers if requested.
+	 * Large pastes may still be in progress when this returns.
+	 */
+	virtual void pasteData(const char *data, size_t size, bool bBracketed)
+	{
+		if (bBracketed)
+		{
+			insertData("\x1B[200~", 6);
+		}
+
+		insertData(data, size);
+
+		if (bBracketed)
+		{
+			insertData("\x1B[201~", 6);
+		}
+	}
+
+	/**
+	 * Sets the size of this terminal in characters.
+	 */
+	virtual void setWindowSize(int nWidth, int nHeight) {}
+
+	/**
+	 * Stops a paste that is still in progress.
+	 */
+	virtual void cancelPaste() {}
+
+	/**
+	 * Called as a paste into the other terminal progresses. Done is set once the paste
+	 * finished or was cancelled.
+	 */
+	virtual void pasteProgress(size_t nSent, size_t nSize, bool bDone) {}
+
+	/**
+	 * Called once the child of the other terminal exited and all of its output was inserted.
+	 * The status is as returned by waitpid, or -1 if it is unknown.
+	 */
+	virtual void childExited(int nStatus) {}
+
+	bool isReady()
+	{
+		return m_bExtTerminalReady;
+	}
+
+	void setReady(bool bReady)
+	{
+		m_bExtTerminalReady = bReady;
+	}
+};
+
+class ExtTerminalContainer
+{
+private:
+	ExtTerminal *m_extTerminal;
+
+public:
+	ExtTerminalContainer()
+	{
+		m_extTerminal = NULL;
+	}
+
+	void setExtTerminal(ExtTerminal *extTerminal)
+	{
+		m_extTerminal = extTerminal;
+	}
+
+	ExtTerminal *getExtTerminal()
+	{
+		return m_extTerminal;
+	}
+};
+
+#endif
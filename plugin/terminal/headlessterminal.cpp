@@ -0,0 +1,361 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headlessterminal.hpp"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "util/logger.hpp"
+
+const int HeadlessTerminal::POLL_MSEC = 10;
+
+/**
+ * Gets the current time in milliseconds.
+ */
+static uint64_t getTimeMsec()
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+
+	return ((uint64_t)now.tv_sec * 1000) + (now.tv_usec / 1000);
+}
+
+HeadlessTerminal::HeadlessTerminal()
+{
+	m_manager = NULL;
+	m_session = NULL;
+	m_client = NULL;
+	m_nNumUpdates = 0;
+	m_bEnded = false;
+
+	pthread_mutex_init(&m_updateLock, NULL);
+	pthread_cond_init(&m_updateCond, NULL);
+}
+
+HeadlessTerminal::~HeadlessTerminal()
+{
+	stop();
+
+	pthread_mutex_destroy(&m_updateLock);
+	pthread_cond_destroy(&m_updateCond);
+}
+
+/**
+ * Starts the I/O threads and a session of the given size running the NULL terminated
+ * command. Without a command the session logs in, like the terminal application does.
+ * Returns 0 if success.
+ */
+int HeadlessTerminal::start(int nWidth, int nHeight, const char *const *command)
+{
+	stop();
+
+	m_manager = new SessionManager();
+
+	if (m_manager->start() != 0)
+	{
+		Logger::getInstance()->error("Cannot start headless session manager.");
+		stop();
+		return -1;
+	}
+
+	m_session = m_manager->createSession(nWidth, nHeight, command);
+
+	if (m_session == NULL)
+	{
+		stop();
+		return -1;
+	}
+
+	m_session->setListener(this);
+
+	return 0;
+}
+
+/**
+ * Attaches to the session at the given index on the session server listening on the socket,
+ * or to a new session there if the index is negative. The session keeps running on the
+ * server once this terminal is stopped.
+ * Returns 0 if success.
+ */
+int HeadlessTerminal::attach(const char *sPath, int nSession, int nWidth, int nHeight, bool bDelta)
+{
+	stop();
+
+	m_client = new SessionClient();
+	m_client->setListener(this);
+
+	if (m_client->connect(sPath) != 0 || m_client->attach(nSession, nWidth, nHeight, bDelta) != 0)
+	{
+		stop();
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Ends the session, or detaches from it, and stops the I/O threads.
+ */
+void HeadlessTerminal::stop()
+{
+	if (m_client != NULL)
+	{
+		delete m_client;
+		m_client = NULL;
+	}
+
+	if (m_manager != NULL)
+	{
+		//Closes the session as well.
+		delete m_manager;
+
+		m_manager = NULL;
+		m_session = NULL;
+	}
+
+	m_bEnded = false;
+}
+
+void HeadlessTerminal::resize(int nWidth, int nHeight)
+{
+	if (m_client != NULL)
+	{
+		m_client->setWindowSize(nWidth, nHeight);
+	}
+	else if (m_session != NULL)
+	{
+		m_session->resize(nWidth, nHeight);
+	}
+}
+
+/**
+ * Sends input to the child as if it was typed. Large input is written in the background.
+ */
+void HeadlessTerminal::sendInput(const char *data, size_t size)
+{
+	if (m_client != NULL)
+	{
+		m_client->insertData(data, size);
+	}
+	else if (m_session != NULL)
+	{
+		m_session->getTerminal()->insertData(data, size);
+	}
+}
+
+/**
+ * Waits until the output settles, which is when the state was not updated for the idle time.
+ * A negative idle time only waits for the child to exit, and a negative timeout waits forever.
+ * Returns 1 if the child exited and all of its output was parsed.
+ * Returns 0 if the output settled. Returns -1 if the wait timed out.
+ */
+int HeadlessTerminal::waitUntilSettled(int nIdleMsec, int nTimeoutMsec)
+{
+	uint64_t nStart = getTimeMsec();
+	uint64_t nLastUpdate = nStart;
+	unsigned long nNumUpdates;
+	bool bWasDone = false;
+
+	pthread_mutex_lock(&m_updateLock);
+	nNumUpdates = m_nNumUpdates;
+	pthread_mutex_unlock(&m_updateLock);
+
+	while (true)
+	{
+		uint64_t nNow = getTimeMsec();
+		bool bDone = isDone();
+
+		pthread_mutex_lock(&m_updateLock);
+		bool bEnded = m_bEnded;
+		pthread_mutex_unlock(&m_updateLock);
+
+		//Output read just before the check may not be in the read ring yet, so unless the
+		//session said it ended, the child must look done twice in a row with no update in between.
+		if (bEnded || (bDone && bWasDone))
+		{
+			return 1;
+		}
+
+		if (nIdleMsec >= 0 && nNow - nLastUpdate >= (uint64_t)nIdleMsec)
+		{
+			return 0;
+		}
+
+		if (nTimeoutMsec >= 0 && nNow - nStart >= (uint64_t)nTimeoutMsec)
+		{
+			return -1;
+		}
+
+		//Kernels without pidfd do not tell when the child exits, so wake up every so often to check on it.
+		uint64_t nWake = nNow + POLL_MSEC;
+		struct timespec deadline;
+
+		deadline.tv_sec = nWake / 1000;
+		deadline.tv_nsec = (nWake % 1000) * 1000000;
+
+		pthread_mutex_lock(&m_updateLock);
+
+		if (m_nNumUpdates == nNumUpdates && !m_bEnded)
+		{
+			pthread_cond_timedwait(&m_updateCond, &m_updateLock, &deadline);
+		}
+
+		if (m_nNumUpdates != nNumUpdates)
+		{
+			nNumUpdates = m_nNumUpdates;
+			nLastUpdate = getTimeMsec();
+			bDone = false;
+		}
+
+		bWasDone = bDone;
+
+		pthread_mutex_unlock(&m_updateLock);
+	}
+}
+
+/**
+ * Returns true if there is no session, or its child exited and all of its output was parsed.
+ * When attached to a session server, returns true once the session ended or the server is gone.
+ */
+bool HeadlessTerminal::isDone()
+{
+	if (m_client != NULL)
+	{
+		return m_client->isClosed();
+	}
+
+	return (m_session == NULL || m_session->getTerminal()->isDone());
+}
+
+/**
+ * Gets the status the child exited with, as returned by waitpid.
+ * Returns -1 if it did not exit, or its status is unknown.
+ */
+int HeadlessTerminal::getExitStatus()
+{
+	if (m_client != NULL)
+	{
+		return m_client->getExitStatus();
+	}
+
+	return (m_session != NULL) ? m_session->getTerminal()->getExitStatus() : -1;
+}
+
+/**
+ * Gets the text on the screen, one line per row with trailing blanks removed.
+ */
+void HeadlessTerminal::getScreenText(std::string &text)
+{
+	VTTerminalState *state = getState();
+	std::string line;
+
+	text.clear();
+
+	if (state == NULL)
+	{
+		return;
+	}
+
+
+	state->lock();
+
+	int nTopLineIndex = state->getBufferTopLineIndex();
+	int nHeight = state->getDisplayScreenSize().getY();
+
+	for (int i = 0; i < nHeight; i++)
+	{
+		DataBuffer *buffer = state->getBufferLine(nTopLineIndex + i);
+
+		line.clear();
+
+		if (buffer != NULL && buffer->size() > 0)
+		{
+			line.resize(buffer->size());
+			buffer->copy(&line[0], line.size());
+
+			//Null characters are displayed as blanks.
+			for (size_t j = 0; j < line.size(); j++)
+			{
+				if (line[j] == '\0')
+				{
+					line[j] = ' ';
+				}
+			}
+
+			line.erase(line.find_last_not_of(' ') + 1);
+		}
+
+		text.append(line);
+		text.append(1, '\n');
+	}
+
+	state->unlock();
+}
+
+Session *HeadlessTerminal::getSession()
+{
+	return m_session;
+}
+
+VTTerminalState *HeadlessTerminal::getState()
+{
+	if (m_client != NULL)
+	{
+		return m_client->getState();
+	}
+
+	return (m_session != NULL) ? m_session->getState() : NULL;
+}
+
+/**
+ * Counts the update and wakes up anyone waiting for the output. Called from the parser thread.
+ */
+void HeadlessTerminal::sessionUpdated(Session *session)
+{
+	pthread_mutex_lock(&m_updateLock);
+	m_nNumUpdates++;
+	pthread_cond_broadcast(&m_updateCond);
+	pthread_mutex_unlock(&m_updateLock);
+}
+
+/**
+ * Wakes up anyone waiting for the child to exit. Called from the parser thread.
+ */
+void HeadlessTerminal::sessionExited(Session *session, int nStatus)
+{
+	pthread_mutex_lock(&m_updateLock);
+	m_bEnded = true;
+	pthread_cond_broadcast(&m_updateCond);
+	pthread_mutex_unlock(&m_updateLock);
+}
+
+/**
+ * Counts the update like a local one. Called from the reader thread of the client.
+ */
+void HeadlessTerminal::clientUpdated(SessionClient *client)
+{
+	sessionUpdated(NULL);
+}
+
+void HeadlessTerminal::clientClosed(SessionClient *client)
+{
+	sessionExited(NULL, client->getExitStatus());
+}
@@ -0,0 +1,72 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSTERMINAL_HPP__
+#define HEADLESSTERMINAL_HPP__
+
+#include <pthread.h>
+
+#include <string>
+
+#include "session.hpp"
+#include "sessionclient.hpp"
+#include "sessionmanager.hpp"
+
+/**
+ * A session run without a display, for automation and benchmarks. It has its own session
+ * manager, so one object drives the whole engine: start a command, send it input, wait
+ * for its output to settle and look at the screen. It can also attach to a session of
+ * a session server instead.
+ */
+class HeadlessTerminal : public SessionListener, public SessionClientListener
+{
+private:
+	static const int POLL_MSEC;
+
+	SessionManager *m_manager;
+	Session *m_session;
+	SessionClient *m_client; //Connection to a session server, when attached to one.
+	unsigned long m_nNumUpdates; //Times the output of the session changed its state.
+	bool m_bEnded; //The session ended and all of its output is in the state.
+	pthread_mutex_t m_updateLock;
+	pthread_cond_t m_updateCond; //Signalled when the state is updated.
+
+public:
+	HeadlessTerminal();
+	virtual ~HeadlessTerminal();
+
+	int start(int nWidth, int nHeight, const char *const *command);
+	int attach(const char *sPath, int nSession, int nWidth, int nHeight, bool bDelta = false);
+	void stop();
+	void resize(int nWidth, int nHeight);
+	void sendInput(const char *data, size_t size);
+	int waitUntilSettled(int nIdleMsec, int nTimeoutMsec);
+	bool isDone();
+	int getExitStatus();
+
+	void getScreenText(std::string &text);
+	Session *getSession();
+	VTTerminalState *getState();
+
+	void sessionUpdated(Session *session);
+	void sessionExited(Session *session, int nStatus);
+	void clientUpdated(SessionClient *client);
+	void clientClosed(SessionClient *client);
+};
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ptybackend.hpp"
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "epollbackend.hpp"
+#include "uringbackend.hpp"
+#include "util/logger.hpp"
+
+PTYBackend::PTYBackend(SessionManager *manager)
+{
+	m_manager = manager;
+	m_wakeFD = -1;
+}
+
+PTYBackend::~PTYBackend()
+{
+	if (m_wakeFD >= 0)
+	{
+		close(m_wakeFD);
+	}
+}
+
+/**
+ * Creates the backend of the given type. With PB_BACKEND_AUTO, io_uring is tried first
+ * and epoll is used if it is not supported by the build or the kernel.
+ * Returns NULL if the backend cannot be set up.
+ */
+PTYBackend *PTYBackend::create(PBBackend_t type, SessionManager *manager)
+{
+	PTYBackend *backend = NULL;
+
+	if (type == PB_BACKEND_AUTO || type == PB_BACKEND_URING)
+	{
+		backend = new UringBackend(manager);
+
+		if (backend->init() != 0)
+		{
+			delete backend;
+			backend = NULL;
+		}
+	}
+
+	if (backend == NULL && (type == PB_BACKEND_AUTO || type == PB_BACKEND_EPOLL))
+	{
+		backend = new EpollBackend(manager);
+
+		if (backend->init() != 0)
+		{
+			delete backend;
+			backend = NULL;
+		}
+	}
+
+	if (backend != NULL)
+	{
+		Logger::getInstance()->info("Using %s for pseudo terminal I/O.", backend->getName());
+	}
+
+	return backend;
+}
+
+/**
+ * Creates the event used to interrupt the reader thread.
+ * Returns 0 if success.
+ */
+int PTYBackend::createWakeEvent()
+{
+	m_wakeFD = eventfd(0, 0);
+
+	if (m_wakeFD < 0)
+	{
+		Logger::getInstance()->error("Cannot create reader wake up event.");
+		return -1;
+	}
+
+	//Keep the descriptor out of child processes.
+	fcntl(m_wakeFD, F_SETFD, FD_CLOEXEC);
+	fcntl(m_wakeFD, F_SETFL, fcntl(m_wakeFD, F_GETFL) | O_NONBLOCK);
+
+	return 0;
+}
+
+void PTYBackend::drainWakeEvent()
+{
+	eventfd_t value;
+
+	eventfd_read(m_wakeFD, &value);
+}
+
+/**
+ * Interrupts the reader thread if it is waiting.
+ */
+void PTYBackend::wake()
+{
+	if (m_wakeFD >= 0)
+	{
+		eventfd_write(m_wakeFD, 1);
+	}
+}
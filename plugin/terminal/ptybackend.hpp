@@ -0,0 +1,71 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PTYBACKEND_HPP__
+#define PTYBACKEND_HPP__
+
+class SessionManager;
+class Terminal;
+
+/**
+ * Events watched on a master.
+ */
+typedef enum
+{
+	PB_READ = 1,
+	PB_WRITE = 2,
+	PB_EXIT = 4 //The child exited. Watched on its pidfd rather than the master.
+} PBEvent_t;
+
+typedef enum
+{
+	PB_BACKEND_AUTO = 0, //io_uring where available, otherwise epoll.
+	PB_BACKEND_EPOLL = 1,
+	PB_BACKEND_URING = 2
+} PBBackend_t;
+
+/**
+ * Waits for and does the I/O on the masters of a session manager's terminals.
+ * The backend runs on the reader thread of the manager; only setEvents() and wake()
+ * may be called from other threads.
+ */
+class PTYBackend
+{
+protected:
+	SessionManager *m_manager;
+	int m_wakeFD;
+
+	int createWakeEvent();
+	void drainWakeEvent();
+
+public:
+	PTYBackend(SessionManager *manager);
+	virtual ~PTYBackend();
+
+	static PTYBackend *create(PBBackend_t type, SessionManager *manager);
+
+	virtual const char *getName() = 0;
+	virtual int init() = 0;
+	virtual int setEvents(Terminal *terminal, int nEvents) = 0;
+	virtual bool isBusy(Terminal *terminal) = 0;
+	virtual int run() = 0;
+
+	void wake();
+};
+
+#endif
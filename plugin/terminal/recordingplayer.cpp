@@ -0,0 +1,457 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recordingplayer.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "terminalsnapshot.hpp"
+#include "util/logger.hpp"
+
+const size_t RecordingPlayer::KEYFRAME_BYTES = (1024 * 1024);
+
+RecordingPlayer::RecordingPlayer()
+{
+	m_reader = new RecordingReader();
+	m_state = NULL;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nTime = 0;
+	m_nDuration = 0;
+	m_nReplayedBytes = 0;
+}
+
+RecordingPlayer::~RecordingPlayer()
+{
+	close();
+	delete m_reader;
+}
+
+/**
+ * Opens a recording and finds its keyframes. The given screen size is used if the
+ * recording does not have one.
+ * Returns 0 if success.
+ */
+int RecordingPlayer::open(const char *sFileName, int nWidth, int nHeight)
+{
+	close();
+
+	if (m_reader->open(sFileName) != 0)
+	{
+		return -1;
+	}
+
+	m_nWidth = (m_reader->getWidth() > 0) ? m_reader->getWidth() : nWidth;
+	m_nHeight = (m_reader->getHeight() > 0) ? m_reader->getHeight() : nHeight;
+
+	const std::vector<SRKeyframe_t> &index = m_reader->getKeyframes();
+
+	for (size_t i = 0; i < index.size(); i++)
+	{
+		RPKeyframe_t keyframe;
+
+		keyframe.nTime = index[i].nTime;
+		keyframe.nOffset = index[i].nOffset;
+		keyframe.data = NULL;
+		keyframe.size = 0;
+		m_keyframes.push_back(keyframe);
+	}
+
+	m_nDuration = m_reader->getEndTime();
+
+	if (m_keyframes.empty())
+	{
+		findKeyframes();
+	}
+
+	rewind();
+
+	return 0;
+}
+
+void RecordingPlayer::close()
+{
+	m_reader->close();
+	freeKeyframes();
+
+	delete m_state;
+	m_state = NULL;
+
+	m_nTime = 0;
+	m_nDuration = 0;
+	m_nReplayedBytes = 0;
+}
+
+void RecordingPlayer::freeKeyframes()
+{
+	for (size_t i = 0; i < m_keyframes.size(); i++)
+	{
+		free(m_keyframes[i].data);
+	}
+
+	m_keyframes.clear();
+}
+
+/**
+ * Replaces the state with a blank one.
+ */
+void RecordingPlayer::resetState()
+{
+	delete m_state;
+
+	m_state = new VTTerminalState();
+	m_state->setDisplayScreenSize(m_nWidth, m_nHeight);
+	m_state->addTerminalModeFlags(TS_TM_AUTO_WRAP);
+}
+
+/**
+ * Goes back to the start of the recording with a blank state.
+ */
+void RecordingPlayer::rewind()
+{
+	resetState();
+	m_reader->rewind();
+	m_nTime = 0;
+}
+
+/**
+ * Looks for keyframe records in a binary log without an index. If there are none, the
+ * keyframes are made by replaying the recording.
+ */
+void RecordingPlayer::findKeyframes()
+{
+	SRRecord_t type;
+	uint64_t nTime;
+	const char *data;
+	size_t size;
+
+	if (m_reader->getFormat() == SR_FORMAT_BINARY)
+	{
+		size_t nOffset = m_reader->getOffset();
+
+		while (m_reader->next(type, nTime, data, size) > 0)
+		{
+			if (type == SR_RECORD_KEYFRAME)
+			{
+				RPKeyframe_t keyframe;
+
+				keyframe.nTime = nTime;
+				keyframe.nOffset = nOffset;
+				keyframe.data = NULL;
+				keyframe.size = 0;
+				m_keyframes.push_back(keyframe);
+			}
+
+			m_nDuration = nTime;
+			nOffset = m_reader->getOffset();
+		}
+	}
+
+	if (m_keyframes.empty())
+	{
+		makeKeyframes();
+	}
+}
+
+/**
+ * Replays the whole recording, keeping a snapshot in memory every so often.
+ */
+void RecordingPlayer::makeKeyframes()
+{
+	SRRecord_t type;
+	uint64_t nTime;
+	const char *data;
+	size_t size;
+	size_t nBytes = 0;
+
+	rewind();
+
+	while (m_reader->next(type, nTime, data, size) > 0)
+	{
+		playRecord(type, data, size);
+		m_nDuration = nTime;
+
+		if (type == SR_RECORD_OUTPUT)
+		{
+			nBytes += size;
+		}
+
+		if (nBytes >= KEYFRAME_BYTES && !m_state->hasPendingSequence())
+		{
+			RPKeyframe_t keyframe;
+			FILE *file;
+
+			keyframe.nTime = nTime;
+			keyframe.nOffset = m_reader->getOffset();
+			keyframe.data = NULL;
+			keyframe.size = 0;
+
+			file = open_memstream(&keyframe.data, &keyframe.size);
+
+			if (file != NULL)
+			{
+				TerminalSnapshot snapshot(file);
+				int nResult = snapshot.save(m_state);
+
+				if (fclose(file) == 0 && nResult == 0)
+				{
+					m_keyframes.push_back(keyframe);
+				}
+				else
+				{
+					free(keyframe.data);
+				}
+			}
+
+			nBytes = 0;
+		}
+	}
+
+	Logger::getInstance()->debug("Made %d keyframes for the recording.", (int)m_keyframes.size());
+}
+
+/**
+ * Replaces the state with a keyframe and continues reading after it.
+ * Returns 0 if success.
+ */
+int RecordingPlayer::loadKeyframe(const RPKeyframe_t &keyframe)
+{
+	const char *data = keyframe.data;
+	size_t size = keyframe.size;
+	SRRecord_t type;
+	uint64_t nTime;
+	FILE *file;
+	int nResult;
+
+	if (m_reader->setOffset(keyframe.nOffset) != 0)
+	{
+		return -1;
+	}
+
+	if (data == NULL && (m_reader->next(type, nTime, data, size) <= 0 || type != SR_RECORD_KEYFRAME))
+	{
+		return -1;
+	}
+
+	file = fmemopen((void *)data, size, "rb");
+
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	resetState();
+
+	TerminalSnapshot snapshot(file);
+	nResult = snapshot.load(m_state);
+	fclose(file);
+
+	m_nTime = keyframe.nTime;
+
+	return nResult;
+}
+
+/**
+ * Applies a record to the state. Keyframes are skipped, since the state already matches.
+ */
+void RecordingPlayer::playRecord(SRRecord_t type, const char *data, size_t size)
+{
+	if (type == SR_RECORD_OUTPUT)
+	{
+		m_state->insertString(data, size, &m_sink);
+		m_nReplayedBytes += size;
+	}
+	else if (type == SR_RECORD_RESIZE)
+	{
+		char sSize[32];
+		int nWidth, nHeight;
+
+		size = (size < sizeof(sSize)) ? size : (sizeof(sSize) - 1);
+		memcpy(sSize, data, size);
+		sSize[size] = '\0';
+
+		if (sscanf(sSize, "%dx%d", &nWidth, &nHeight) == 2 && nWidth > 0 && nHeight > 0)
+		{
+			m_state->resizeDisplayScreen(nWidth, nHeight);
+		}
+	}
+}
+
+/**
+ * Plays the records up to and including the given time.
+ */
+void RecordingPlayer::play(uint64_t nTime)
+{
+	SRRecord_t type;
+	uint64_t nRecordTime;
+	const char *data;
+	size_t size;
+
+	while (true)
+	{
+		size_t nOffset = m_reader->getOffset();
+
+		if (m_reader->next(type, nRecordTime, data, size) <= 0)
+		{
+			break;
+		}
+
+		if (nRecordTime > nTime)
+		{
+			m_reader->setOffset(nOffset);
+			break;
+		}
+
+		playRecord(type, data, size);
+		m_nTime = nRecordTime;
+	}
+}
+
+/**
+ * Moves to the given time, in microseconds from the start. Playback continues from the
+ * current position if no keyframe is closer.
+ * Returns -1 if a keyframe cannot be loaded. Returns 0 if success.
+ */
+int RecordingPlayer::seek(uint64_t nTime)
+{
+	int nLow = 0;
+	int nHigh = m_keyframes.size();
+	int nResult = 0;
+
+	//Find the last keyframe at or before the time.
+	while (nLow < nHigh)
+	{
+		int nMiddle = (nLow + nHigh) / 2;
+
+		if (m_keyframes[nMiddle].nTime <= nTime)
+		{
+			nLow = nMiddle + 1;
+		}
+		else
+		{
+			nHigh = nMiddle;
+		}
+	}
+
+	m_nReplayedBytes = 0;
+
+	if (nTime < m_nTime || (nLow > 0 && m_reader->getOffset() <= m_keyframes[nLow - 1].nOffset))
+	{
+		if (nLow == 0)
+		{
+			rewind();
+		}
+		else if (loadKeyframe(m_keyframes[nLow - 1]) != 0)
+		{
+			Logger::getInstance()->error("Cannot load keyframe.");
+			rewind();
+			nResult = -1;
+		}
+	}
+
+	play(nTime);
+
+	return nResult;
+}
+
+/**
+ * Moves to the given offset in the recording: every record that starts before it is
+ * played. This is the way to seek in raw recordings, which have no time.
+ * Returns -1 if a keyframe cannot be loaded. Returns 0 if success.
+ */
+int RecordingPlayer::seekToOffset(size_t nOffset)
+{
+	SRRecord_t type;
+	uint64_t nTime;
+	const char *data;
+	size_t size;
+	int nKeyframe = m_keyframes.size() - 1;
+	int nResult = 0;
+
+	while (nKeyframe >= 0 && m_keyframes[nKeyframe].nOffset > nOffset)
+	{
+		nKeyframe--;
+	}
+
+	m_nReplayedBytes = 0;
+
+	if (nOffset < m_reader->getOffset() || (nKeyframe >= 0 && m_reader->getOffset() <= m_keyframes[nKeyframe].nOffset))
+	{
+		if (nKeyframe < 0)
+		{
+			rewind();
+		}
+		else if (loadKeyframe(m_keyframes[nKeyframe]) != 0)
+		{
+			Logger::getInstance()->error("Cannot load keyframe.");
+			rewind();
+			nResult = -1;
+		}
+	}
+
+	while (m_reader->getOffset() < nOffset && m_reader->next(type, nTime, data, size) > 0)
+	{
+		playRecord(type, data, size);
+		m_nTime = nTime;
+	}
+
+	return nResult;
+}
+
+/**
+ * Gets the state being played into. It is replaced by seeking.
+ */
+VTTerminalState *RecordingPlayer::getState()
+{
+	return m_state;
+}
+
+RecordingReader *RecordingPlayer::getReader()
+{
+	return m_reader;
+}
+
+/**
+ * Gets the time of the last record played, in microseconds from the start.
+ */
+uint64_t RecordingPlayer::getTime()
+{
+	return m_nTime;
+}
+
+/**
+ * Gets the length of the recording in microseconds.
+ */
+uint64_t RecordingPlayer::getDuration()
+{
+	return m_nDuration;
+}
+
+int RecordingPlayer::getNumKeyframes()
+{
+	return m_keyframes.size();
+}
+
+/**
+ * Gets how much output the last seek replayed on top of its keyframe.
+ */
+size_t RecordingPlayer::getReplayedBytes()
+{
+	return m_nReplayedBytes;
+}
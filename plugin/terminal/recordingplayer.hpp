@@ -0,0 +1,92 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDINGPLAYER_HPP__
+#define RECORDINGPLAYER_HPP__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "extterminal.hpp"
+#include "recordingreader.hpp"
+#include "vtterminalstate.hpp"
+
+/**
+ * A state to start playback from.
+ */
+typedef struct
+{
+	uint64_t nTime;
+	size_t nOffset; //Start of the keyframe record, or of the record after it for a snapshot in memory.
+	char *data; //Snapshot kept in memory. NULL if it is in the recording.
+	size_t size;
+} RPKeyframe_t;
+
+/**
+ * Plays a recording back into a terminal state. Seeking loads the nearest keyframe before
+ * the target and replays only the output after it.
+ *
+ * Keyframes come from the index of a binary log. A binary log cut off before its index
+ * is scanned for keyframe records instead. Recordings without keyframes are replayed
+ * once when opened, keeping a snapshot in memory every KEYFRAME_BYTES of output.
+ */
+class RecordingPlayer
+{
+private:
+	static const size_t KEYFRAME_BYTES;
+
+	RecordingReader *m_reader;
+	VTTerminalState *m_state;
+	ExtTerminal m_sink; //Takes the replies of the state, which go nowhere.
+	std::vector<RPKeyframe_t> m_keyframes; //In the order of the recording.
+	int m_nWidth;
+	int m_nHeight;
+	uint64_t m_nTime; //Time of the last record played.
+	uint64_t m_nDuration;
+	size_t m_nReplayedBytes; //Output replayed since the last seek.
+
+	void freeKeyframes();
+	void resetState();
+	void rewind();
+	void findKeyframes();
+	void makeKeyframes();
+	int loadKeyframe(const RPKeyframe_t &keyframe);
+	void playRecord(SRRecord_t type, const char *data, size_t size);
+
+public:
+	RecordingPlayer();
+	~RecordingPlayer();
+
+	int open(const char *sFileName, int nWidth, int nHeight);
+	void close();
+
+	void play(uint64_t nTime);
+	int seek(uint64_t nTime);
+	int seekToOffset(size_t nOffset);
+
+	VTTerminalState *getState();
+	RecordingReader *getReader();
+	uint64_t getTime();
+	uint64_t getDuration();
+	int getNumKeyframes();
+	size_t getReplayedBytes();
+};
+
+#endif
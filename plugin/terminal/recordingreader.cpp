@@ -0,0 +1,742 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recordingreader.hpp"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/logger.hpp"
+
+const size_t RecordingReader::DEFAULT_CHUNK_SIZE = 4096;
+
+static unsigned int getInt(const char *data)
+{
+	const unsigned char *buffer = (const unsigned char *)data;
+
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((unsigned int)buffer[3] << 24);
+}
+
+static uint64_t getInt64(const char *data)
+{
+	return getInt(data) | ((uint64_t)getInt(data + 4) << 32);
+}
+
+static int getHexDigit(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	else if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	else if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+RecordingReader::RecordingReader()
+{
+	m_fd = -1;
+	m_data = NULL;
+	m_size = 0;
+	m_nOffset = 0;
+	m_nEnd = 0;
+	m_nEndTime = 0;
+	m_format = SR_FORMAT_RAW;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nChunkSize = DEFAULT_CHUNK_SIZE;
+	m_text = NULL;
+	m_nTextCapacity = 0;
+}
+
+RecordingReader::~RecordingReader()
+{
+	close();
+	free(m_text);
+}
+
+/**
+ * Opens a recording and reads its header.
+ * Returns 0 if success.
+ */
+int RecordingReader::open(const char *sFileName)
+{
+	struct stat info;
+
+	close();
+
+	m_fd = ::open(sFileName, O_RDONLY);
+
+	if (m_fd < 0 || fstat(m_fd, &info) < 0)
+	{
+		Logger::getInstance()->error("Cannot open recording: '%s'", sFileName);
+		close();
+		return -1;
+	}
+
+	m_size = info.st_size;
+
+	if (m_size > 0)
+	{
+		m_data = (char *)mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+
+		if (m_data == MAP_FAILED)
+		{
+			Logger::getInstance()->error("Cannot map recording: '%s'", sFileName);
+			m_data = NULL;
+			close();
+			return -1;
+		}
+
+		madvise(m_data, m_size, MADV_SEQUENTIAL);
+	}
+
+	m_nEnd = m_size;
+
+	if (parseHeader() != 0)
+	{
+		Logger::getInstance()->error("Invalid recording: '%s'", sFileName);
+		close();
+		return -1;
+	}
+
+	return 0;
+}
+
+void RecordingReader::close()
+{
+	if (m_data != NULL)
+	{
+		munmap(m_data, m_size);
+		m_data = NULL;
+	}
+
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	m_size = 0;
+	m_nOffset = 0;
+	m_nEnd = 0;
+	m_nEndTime = 0;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_keyframes.clear();
+}
+
+/**
+ * Detects the format and reads the screen size. A raw file has no header, so its size
+ * is left at 0.
+ * Returns 0 if success.
+ */
+int RecordingReader::parseHeader()
+{
+	const char *end = m_data + m_size;
+	const char *start = skipSpaces(m_data, end);
+
+	m_nOffset = 0;
+	m_nWidth = 0;
+	m_nHeight = 0;
+
+	if (m_size >= 4 && getInt(m_data) == SessionRecorder::MAGIC)
+	{
+		if (m_size < SessionRecorder::FILE_HEADER_SIZE || (int)getInt(m_data + 4) != SessionRecorder::VERSION)
+		{
+			return -1;
+		}
+
+		m_format = SR_FORMAT_BINARY;
+		m_nWidth = getInt(m_data + 8);
+		m_nHeight = getInt(m_data + 12);
+		m_nOffset = SessionRecorder::FILE_HEADER_SIZE;
+		parseIndex();
+	}
+	else if (start < end && *start == '{')
+	{
+		const char *lineEnd = (const char *)memchr(start, '\n', end - start);
+		int nVersion = 0;
+
+		if (lineEnd == NULL)
+		{
+			lineEnd = end;
+		}
+
+		if (findNumber(start, lineEnd, "\"version\"", nVersion) != 0 || nVersion != 2)
+		{
+			return -1;
+		}
+
+		m_format = SR_FORMAT_ASCIICAST;
+		findNumber(start, lineEnd, "\"width\"", m_nWidth);
+		findNumber(start, lineEnd, "\"height\"", m_nHeight);
+		m_nOffset = (lineEnd < end) ? (lineEnd - m_data + 1) : m_size;
+	}
+	else
+	{
+		m_format = SR_FORMAT_RAW;
+	}
+
+	return 0;
+}
+
+/**
+ * Reads the keyframe index of a binary log, if it has the trailer. The index record then
+ * ends the records.
+ */
+void RecordingReader::parseIndex()
+{
+	const char *trailer;
+	uint64_t nIndexOffset;
+	size_t nSize;
+
+	m_keyframes.clear();
+
+	if (m_size < SessionRecorder::FILE_HEADER_SIZE + SessionRecorder::RECORD_HEADER_SIZE + SessionRecorder::TRAILER_SIZE)
+	{
+		return;
+	}
+
+	trailer = m_data + m_size - SessionRecorder::TRAILER_SIZE;
+
+	if (getInt(trailer + 8) != SessionRecorder::INDEX_MAGIC)
+	{
+		return;
+	}
+
+	nIndexOffset = getInt64(trailer);
+
+	if (nIndexOffset < SessionRecorder::FILE_HEADER_SIZE
+		|| nIndexOffset > m_size - SessionRecorder::TRAILER_SIZE - SessionRecorder::RECORD_HEADER_SIZE
+		|| m_data[nIndexOffset] != SR_RECORD_INDEX)
+	{
+		Logger::getInstance()->warn("Invalid recording index.");
+		return;
+	}
+
+	nSize = getInt(m_data + nIndexOffset + 9);
+
+	if (nIndexOffset + SessionRecorder::RECORD_HEADER_SIZE + nSize != m_size - SessionRecorder::TRAILER_SIZE)
+	{
+		Logger::getInstance()->warn("Invalid recording index.");
+		return;
+	}
+
+	for (size_t i = 0; i + 16 <= nSize; i += 16)
+	{
+		const char *entry = m_data + nIndexOffset + SessionRecorder::RECORD_HEADER_SIZE + i;
+		SRKeyframe_t keyframe;
+
+		keyframe.nTime = getInt64(entry);
+		keyframe.nOffset = getInt64(entry + 8);
+
+		if (keyframe.nOffset >= SessionRecorder::FILE_HEADER_SIZE && keyframe.nOffset < nIndexOffset)
+		{
+			m_keyframes.push_back(keyframe);
+		}
+	}
+
+	m_nEnd = nIndexOffset;
+	m_nEndTime = getInt64(m_data + nIndexOffset + 1);
+}
+
+/**
+ * Reads the next record. The data stays valid until the next call.
+ * Returns 1 if a record was read, 0 at the end of the recording, or -1 if the rest of
+ * the recording cannot be read.
+ */
+int RecordingReader::next(SRRecord_t &type, uint64_t &nTime, const char *&data, size_t &size)
+{
+	const char *end = m_data + m_nEnd;
+
+	if (m_format == SR_FORMAT_RAW)
+	{
+		if (m_nOffset >= m_nEnd)
+		{
+			return 0;
+		}
+
+		type = SR_RECORD_OUTPUT;
+		nTime = 0;
+		data = m_data + m_nOffset;
+		size = (m_nEnd - m_nOffset < m_nChunkSize) ? (m_nEnd - m_nOffset) : m_nChunkSize;
+		m_nOffset += size;
+
+		return 1;
+	}
+	else if (m_format == SR_FORMAT_BINARY)
+	{
+		const char *header = m_data + m_nOffset;
+
+		if (m_nOffset >= m_nEnd)
+		{
+			return 0;
+		}
+
+		if (m_nEnd - m_nOffset < SessionRecorder::RECORD_HEADER_SIZE
+			|| m_nEnd - m_nOffset - SessionRecorder::RECORD_HEADER_SIZE < getInt(header + 9))
+		{
+			Logger::getInstance()->warn("Recording is cut off.");
+			m_nOffset = m_nEnd;
+			return -1;
+		}
+
+		type = (SRRecord_t)(unsigned char)header[0];
+		nTime = getInt64(header + 1);
+		data = header + SessionRecorder::RECORD_HEADER_SIZE;
+		size = getInt(header + 9);
+		m_nOffset += SessionRecorder::RECORD_HEADER_SIZE + size;
+
+		return 1;
+	}
+
+	while (m_nOffset < m_nEnd)
+	{
+		const char *line = m_data + m_nOffset;
+		const char *lineEnd = (const char *)memchr(line, '\n', end - line);
+
+		if (lineEnd == NULL)
+		{
+			lineEnd = end;
+		}
+
+		m_nOffset = (lineEnd < end) ? (lineEnd - m_data + 1) : m_nEnd;
+
+		if (skipSpaces(line, lineEnd) == lineEnd)
+		{
+			continue;
+		}
+
+		if (parseEvent(line, lineEnd, type, nTime, data, size) == 0)
+		{
+			return 1;
+		}
+
+		Logger::getInstance()->warn("Skipping invalid asciicast event.");
+	}
+
+	return 0;
+}
+
+/**
+ * Goes back to the first record.
+ */
+void RecordingReader::rewind()
+{
+	parseHeader();
+}
+
+/**
+ * Continues reading at the given offset, which must be the start of a record, as
+ * returned by getOffset() or found in the keyframe index.
+ * Returns 0 if success.
+ */
+int RecordingReader::setOffset(size_t nOffset)
+{
+	if (nOffset > m_nEnd)
+	{
+		return -1;
+	}
+
+	m_nOffset = nOffset;
+
+	return 0;
+}
+
+/**
+ * Parses an asciicast event line: [time, "code", "data"].
+ * Returns 0 if success.
+ */
+int RecordingReader::parseEvent(const char *line, const char *end, SRRecord_t &type, uint64_t &nTime, const char *&data, size_t &size)
+{
+	const char *src = skipSpaces(line, end);
+	size_t nCodeSize;
+
+	if (src >= end || *src != '[')
+	{
+		return -1;
+	}
+
+	src = skipSpaces(src + 1, end);
+
+	if (parseNumber(src, end, nTime, 6) != 0)
+	{
+		return -1;
+	}
+
+	src = skipSpaces(src, end);
+
+	if (src >= end || *src != ',')
+	{
+		return -1;
+	}
+
+	src = skipSpaces(src + 1, end);
+
+	if (decodeString(src, end, nCodeSize) != 0 || nCodeSize == 0)
+	{
+		return -1;
+	}
+
+	type = (SRRecord_t)(unsigned char)m_text[0];
+	src = skipSpaces(src, end);
+
+	if (src >= end || *src != ',')
+	{
+		return -1;
+	}
+
+	src = skipSpaces(src + 1, end);
+
+	if (decodeString(src, end, size) != 0)
+	{
+		return -1;
+	}
+
+	src = skipSpaces(src, end);
+
+	if (src >= end || *src != ']')
+	{
+		return -1;
+	}
+
+	data = m_text;
+
+	return 0;
+}
+
+/**
+ * Decodes a JSON string into the text buffer, as UTF-8. The source is left after the
+ * closing quote.
+ * Returns 0 if success.
+ */
+int RecordingReader::decodeString(const char *&src, const char *end, size_t &size)
+{
+	size_t nLength = end - src;
+
+	if (src >= end || *src != '"')
+	{
+		return -1;
+	}
+
+	//Decoding never makes the string longer.
+	if (nLength > m_nTextCapacity)
+	{
+		char *text = (char *)realloc(m_text, nLength);
+
+		if (text == NULL)
+		{
+			return -1;
+		}
+
+		m_text = text;
+		m_nTextCapacity = nLength;
+	}
+
+	size = 0;
+	src++;
+
+	while (src < end && *src != '"')
+	{
+		if (*src != '\\')
+		{
+			const char *start = src;
+
+			while (src < end && *src != '"' && *src != '\\')
+			{
+				src++;
+			}
+
+			memcpy(m_text + size, start, src - start);
+			size += src - start;
+			continue;
+		}
+
+		if (end - src < 2)
+		{
+			return -1;
+		}
+
+		char c = src[1];
+		src += 2;
+
+		switch (c)
+		{
+		case 'n':
+			m_text[size++] = '\n';
+			break;
+		case 'r':
+			m_text[size++] = '\r';
+			break;
+		case 't':
+			m_text[size++] = '\t';
+			break;
+		case 'b':
+			m_text[size++] = '\b';
+			break;
+		case 'f':
+			m_text[size++] = '\f';
+			break;
+		case 'u':
+		{
+			unsigned int nCode = 0;
+
+			for (int nUnits = 0; nUnits < 2; nUnits++)
+			{
+				unsigned int nUnit = 0;
+
+				if (end - src < 4)
+				{
+					return -1;
+				}
+
+				for (int i = 0; i < 4; i++)
+				{
+					int nDigit = getHexDigit(src[i]);
+
+					if (nDigit < 0)
+					{
+						return -1;
+					}
+
+					nUnit = (nUnit << 4) | nDigit;
+				}
+
+				src += 4;
+
+				if (nUnits == 0)
+				{
+					nCode = nUnit;
+
+					//A high surrogate is followed by the low one.
+					if (nUnit < 0xD800 || nUnit > 0xDBFF || end - src < 2 || src[0] != '\\' || src[1] != 'u')
+					{
+						break;
+					}
+
+					src += 2;
+				}
+				else
+				{
+					nCode = 0x10000 + ((nCode - 0xD800) << 10) + (nUnit - 0xDC00);
+				}
+			}
+
+			if (nCode < 0x80)
+			{
+				m_text[size++] = nCode;
+			}
+			else if (nCode < 0x800)
+			{
+				m_text[size++] = 0xC0 | (nCode >> 6);
+				m_text[size++] = 0x80 | (nCode & 0x3F);
+			}
+			else if (nCode < 0x10000)
+			{
+				m_text[size++] = 0xE0 | (nCode >> 12);
+				m_text[size++] = 0x80 | ((nCode >> 6) & 0x3F);
+				m_text[size++] = 0x80 | (nCode & 0x3F);
+			}
+			else
+			{
+				m_text[size++] = 0xF0 | (nCode >> 18);
+				m_text[size++] = 0x80 | ((nCode >> 12) & 0x3F);
+				m_text[size++] = 0x80 | ((nCode >> 6) & 0x3F);
+				m_text[size++] = 0x80 | (nCode & 0x3F);
+			}
+
+			break;
+		}
+		default:
+			//Quotes, backslashes and slashes stand for themselves.
+			m_text[size++] = c;
+			break;
+		}
+	}
+
+	if (src >= end)
+	{
+		return -1;
+	}
+
+	src++;
+
+	return 0;
+}
+
+/**
+ * Parses a decimal number, scaled by the given number of fraction digits.
+ * Returns 0 if success.
+ */
+int RecordingReader::parseNumber(const char *&src, const char *end, uint64_t &nValue, int nFractionDigits)
+{
+	const char *start = src;
+
+	nValue = 0;
+
+	while (src < end && *src >= '0' && *src <= '9')
+	{
+		nValue = (nValue * 10) + (*src - '0');
+		src++;
+	}
+
+	if (src == start)
+	{
+		return -1;
+	}
+
+	if (src < end && *src == '.')
+	{
+		src++;
+
+		while (src < end && *src >= '0' && *src <= '9')
+		{
+			if (nFractionDigits > 0)
+			{
+				nValue = (nValue * 10) + (*src - '0');
+				nFractionDigits--;
+			}
+
+			src++;
+		}
+	}
+
+	while (nFractionDigits > 0)
+	{
+		nValue *= 10;
+		nFractionDigits--;
+	}
+
+	return 0;
+}
+
+/**
+ * Finds the integer value of a key in a JSON object on one line.
+ * Returns 0 if success.
+ */
+int RecordingReader::findNumber(const char *line, const char *end, const char *sKey, int &nValue)
+{
+	size_t nKeySize = strlen(sKey);
+	const char *src = line;
+	uint64_t nNumber;
+
+	while ((size_t)(end - src) >= nKeySize)
+	{
+		const char *key = (const char *)memchr(src, sKey[0], end - src - nKeySize + 1);
+
+		if (key == NULL)
+		{
+			break;
+		}
+
+		src = key + 1;
+
+		if (memcmp(key, sKey, nKeySize) == 0)
+		{
+			const char *value = skipSpaces(key + nKeySize, end);
+
+			if (value < end && *value == ':')
+			{
+				value = skipSpaces(value + 1, end);
+
+				if (parseNumber(value, end, nNumber, 0) == 0)
+				{
+					nValue = nNumber;
+					return 0;
+				}
+			}
+		}
+	}
+
+	return -1;
+}
+
+const char *RecordingReader::skipSpaces(const char *src, const char *end)
+{
+	while (src < end && (*src == ' ' || *src == '\t' || *src == '\r' || *src == '\n'))
+	{
+		src++;
+	}
+
+	return src;
+}
+
+SRFormat_t RecordingReader::getFormat()
+{
+	return m_format;
+}
+
+int RecordingReader::getWidth()
+{
+	return m_nWidth;
+}
+
+int RecordingReader::getHeight()
+{
+	return m_nHeight;
+}
+
+size_t RecordingReader::getSize()
+{
+	return m_size;
+}
+
+/**
+ * Gets the offset of the next record in the file.
+ */
+size_t RecordingReader::getOffset()
+{
+	return m_nOffset;
+}
+
+/**
+ * Gets the keyframes listed in the index of a binary log, in the order they were
+ * written. Empty if the recording has no index.
+ */
+const std::vector<SRKeyframe_t> &RecordingReader::getKeyframes()
+{
+	return m_keyframes;
+}
+
+/**
+ * Gets the time the recording stopped, or 0 if it has no index to tell.
+ */
+uint64_t RecordingReader::getEndTime()
+{
+	return m_nEndTime;
+}
+
+/**
+ * Sets the size of the records a raw file is cut into.
+ */
+void RecordingReader::setChunkSize(size_t size)
+{
+	m_nChunkSize = (size > 0) ? size : DEFAULT_CHUNK_SIZE;
+}
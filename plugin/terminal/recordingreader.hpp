@@ -0,0 +1,85 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDINGREADER_HPP__
+#define RECORDINGREADER_HPP__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "sessionrecorder.hpp"
+
+/**
+ * Reads back a recording made by SessionRecorder: a binary log, asciicast v2, or raw
+ * output bytes. The format is detected from the start of the file.
+ *
+ * The file is mapped into memory, so records of the binary log and raw chunks point
+ * straight into it. Asciicast output is decoded into a buffer that is reused by the
+ * next record. The keyframe index of a binary log is read from its trailer.
+ */
+class RecordingReader
+{
+private:
+	static const size_t DEFAULT_CHUNK_SIZE;
+
+	int m_fd;
+	char *m_data;
+	size_t m_size;
+	size_t m_nOffset; //Start of the next record.
+	size_t m_nEnd; //End of the records.
+	uint64_t m_nEndTime; //Time the recording stopped, if it has an index.
+	SRFormat_t m_format;
+	int m_nWidth;
+	int m_nHeight;
+	size_t m_nChunkSize; //Size of the records a raw file is cut into.
+	char *m_text; //Decoded asciicast data.
+	size_t m_nTextCapacity;
+	std::vector<SRKeyframe_t> m_keyframes;
+
+	int parseHeader();
+	void parseIndex();
+	int parseEvent(const char *line, const char *end, SRRecord_t &type, uint64_t &nTime, const char *&data, size_t &size);
+	int decodeString(const char *&src, const char *end, size_t &size);
+	static int parseNumber(const char *&src, const char *end, uint64_t &nValue, int nFractionDigits);
+	static int findNumber(const char *line, const char *end, const char *sKey, int &nValue);
+	static const char *skipSpaces(const char *src, const char *end);
+
+public:
+	RecordingReader();
+	~RecordingReader();
+
+	int open(const char *sFileName);
+	void close();
+
+	int next(SRRecord_t &type, uint64_t &nTime, const char *&data, size_t &size);
+	void rewind();
+	int setOffset(size_t nOffset);
+
+	SRFormat_t getFormat();
+	int getWidth();
+	int getHeight();
+	size_t getSize();
+	size_t getOffset();
+	const std::vector<SRKeyframe_t> &getKeyframes();
+	uint64_t getEndTime();
+	void setChunkSize(size_t size);
+};
+
+#endif
@@ -0,0 +1,587 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screendelta.hpp"
+
+#include <limits.h>
+#include <string.h>
+
+#include "util/logger.hpp"
+
+ScreenDeltaEncoder::ScreenDeltaEncoder()
+{
+	m_nModes = 0;
+	m_bValid = false;
+}
+
+ScreenDeltaEncoder::~ScreenDeltaEncoder()
+{
+	reset();
+}
+
+/**
+ * Forgets the screen sent last, so that the next delta sends the whole screen.
+ */
+void ScreenDeltaEncoder::reset()
+{
+	for (size_t i = 0; i < m_lines.size(); i++)
+	{
+		releaseLine(m_lines[i]);
+	}
+
+	m_lines.clear();
+	m_bValid = false;
+}
+
+void ScreenDeltaEncoder::releaseLine(SDLine_t &line)
+{
+	if (line.text != NULL)
+	{
+		delete line.text;
+		line.text = NULL;
+	}
+
+	line.nHash = 0;
+	line.bBlank = true;
+	line.spans.clear();
+}
+
+void ScreenDeltaEncoder::putShort(std::vector<char> &delta, int nValue)
+{
+	delta.push_back(nValue & 0xFF);
+	delta.push_back((nValue >> 8) & 0xFF);
+}
+
+/**
+ * Gets a line of the display as it is now. The text is not copied, so the line is only
+ * valid while the state stays locked.
+ */
+void ScreenDeltaEncoder::getLine(TerminalState *state, int nLine, SDLine_t &line)
+{
+	int nWidth = m_size.getX();
+	int nNumStates = 0;
+
+	line.text = state->getBufferLine(state->getBufferTopLineIndex() + nLine - 1);
+	line.nHash = (line.text != NULL) ? line.text->hash() : 0;
+	line.bBlank = true;
+	line.spans.clear();
+
+	if (line.text != NULL && line.text->size() > 0)
+	{
+		m_text.resize(line.text->size());
+		line.text->copy(&m_text[0], m_text.size());
+
+		for (size_t i = 0; i < m_text.size() && line.bBlank; i++)
+		{
+			line.bBlank = (m_text[i] == TerminalState::BLANK || m_text[i] == '\0');
+		}
+	}
+
+	//Turns the graphics states into runs of columns. The first one may be left over from an earlier line.
+	if (m_states.size() < (size_t)(nWidth + 1))
+	{
+		m_states.resize(nWidth + 1);
+	}
+
+	state->getLineGraphicsState(nLine, &m_states[0], nNumStates, m_states.size());
+
+	if (nNumStates > (int)m_states.size())
+	{
+		nNumStates = m_states.size();
+	}
+
+	for (int i = 0; i < nNumStates; i++)
+	{
+		TSLineGraphicsState_t *graphicsState = m_states[i];
+		int nStart = (graphicsState->nLine == nLine && i > 0) ? graphicsState->nColumn : 1;
+		int nEnd = nWidth + 1;
+
+		if (i + 1 < nNumStates && m_states[i + 1]->nLine == nLine && m_states[i + 1]->nColumn < nEnd)
+		{
+			nEnd = m_states[i + 1]->nColumn;
+		}
+
+		if (nEnd <= nStart)
+		{
+			continue;
+		}
+
+		if (!line.spans.empty()
+			&& line.spans.back().foregroundColor == graphicsState->foregroundColor
+			&& line.spans.back().backgroundColor == graphicsState->backgroundColor
+			&& line.spans.back().nGraphicsMode == graphicsState->nGraphicsMode)
+		{
+			line.spans.back().nLength += (nEnd - nStart);
+		}
+		else
+		{
+			SDSpan_t span;
+
+			span.nLength = (nEnd - nStart);
+			span.foregroundColor = graphicsState->foregroundColor;
+			span.backgroundColor = graphicsState->backgroundColor;
+			span.nGraphicsMode = graphicsState->nGraphicsMode;
+
+			line.spans.push_back(span);
+		}
+	}
+
+	for (size_t i = 0; i < line.spans.size(); i++)
+	{
+		line.nHash = (line.nHash ^ line.spans[i].nLength) * 16777619U;
+		line.nHash = (line.nHash ^ ((line.spans[i].foregroundColor << 16) | (line.spans[i].backgroundColor << 8) | line.spans[i].nGraphicsMode)) * 16777619U;
+	}
+}
+
+bool ScreenDeltaEncoder::isSameLine(SDLine_t &line, SDLine_t &sent)
+{
+	if (sent.text == NULL || line.text == NULL || line.nHash != sent.nHash || line.spans.size() != sent.spans.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < line.spans.size(); i++)
+	{
+		if (line.spans[i].nLength != sent.spans[i].nLength
+			|| line.spans[i].foregroundColor != sent.spans[i].foregroundColor
+			|| line.spans[i].backgroundColor != sent.spans[i].backgroundColor
+			|| line.spans[i].nGraphicsMode != sent.spans[i].nGraphicsMode)
+		{
+			return false;
+		}
+	}
+
+	return line.text->equals(sent.text);
+}
+
+/**
+ * Finds how far the lines sent last moved within the scroll region, by counting the lines
+ * that match at each distance. Blank lines match too easily to count.
+ * Returns the number of lines scrolled up, negative for down, or 0 if there was no scroll.
+ */
+int ScreenDeltaEncoder::findScroll(std::vector<SDLine_t> &lines, int nTop, int nBottom)
+{
+	int nBest = 0;
+	int nBestMatches = 0;
+
+	for (int nDistance = 0; nDistance <= (nBottom - nTop); nDistance++)
+	{
+		for (int nSign = 1; nSign >= -1; nSign -= 2)
+		{
+			int nLines = nDistance * nSign;
+			int nMatches = 0;
+
+			for (int i = nTop; i <= nBottom; i++)
+			{
+				int nSource = i + nLines;
+
+				if (nSource >= nTop && nSource <= nBottom && !lines[i - 1].bBlank
+					&& m_lines[nSource - 1].text != NULL && lines[i - 1].nHash == m_lines[nSource - 1].nHash)
+				{
+					nMatches++;
+				}
+			}
+
+			//Staying put wins a tie.
+			if (nMatches > nBestMatches)
+			{
+				nBest = nLines;
+				nBestMatches = nMatches;
+			}
+
+			if (nDistance == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	return nBest;
+}
+
+/**
+ * Moves the lines sent last the way the other side moves them on a scroll.
+ * The lines scrolled in are not known to be blank, since scrolling down can bring back history.
+ */
+void ScreenDeltaEncoder::scroll(int nTop, int nBottom, int nLines)
+{
+	std::vector<SDLine_t> region(nBottom - nTop + 1);
+	std::vector<bool> used(region.size(), false);
+
+	for (int i = nTop; i <= nBottom; i++)
+	{
+		int nSource = i + nLines;
+
+		if (nSource >= nTop && nSource <= nBottom)
+		{
+			region[i - nTop] = m_lines[nSource - 1];
+			used[nSource - nTop] = true;
+		}
+		else
+		{
+			region[i - nTop].text = NULL;
+			region[i - nTop].nHash = 0;
+			region[i - nTop].bBlank = true;
+		}
+	}
+
+	for (int i = nTop; i <= nBottom; i++)
+	{
+		if (!used[i - nTop])
+		{
+			releaseLine(m_lines[i - 1]);
+		}
+
+		m_lines[i - 1] = region[i - nTop];
+	}
+}
+
+/**
+ * Makes the delta that takes the screen sent last to the current screen of the state,
+ * and remembers the current screen as sent. The delta is empty if nothing changed.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int ScreenDeltaEncoder::encode(TerminalState *state, std::vector<char> &delta)
+{
+	std::vector<SDLine_t> lines;
+
+	delta.clear();
+
+	if (state == NULL)
+	{
+		return -1;
+	}
+
+	state->lock();
+
+	Point size = state->getDisplayScreenSize();
+	Point cursor = state->getDisplayCursorLocation();
+	int nModes = (state->getTerminalModeFlags() & ~TS_TM_ORIGIN); //The cursor is sent relative to the screen.
+	bool bFull = (!m_bValid || size.getX() != m_size.getX() || size.getY() != m_size.getY());
+
+	if (bFull)
+	{
+		SDLine_t unknown;
+
+		unknown.text = NULL;
+		unknown.nHash = 0;
+		unknown.bBlank = true;
+
+		reset();
+		m_size = size;
+		m_lines.resize(size.getY(), unknown);
+
+		delta.push_back(SD_OP_SIZE);
+		putShort(delta, size.getX());
+		putShort(delta, size.getY());
+	}
+
+	if (bFull || nModes != m_nModes)
+	{
+		m_nModes = nModes;
+
+		delta.push_back(SD_OP_MODES);
+		putShort(delta, nModes);
+	}
+
+	lines.resize(size.getY());
+
+	for (int i = 0; i < size.getY(); i++)
+	{
+		getLine(state, i + 1, lines[i]);
+	}
+
+	if (!bFull)
+	{
+		int nTop = state->getTopMargin();
+		int nBottom = state->getBottomMargin();
+		int nLines = findScroll(lines, nTop, nBottom);
+
+		if (nLines != 0)
+		{
+			scroll(nTop, nBottom, nLines);
+
+			delta.push_back(SD_OP_SCROLL);
+			putShort(delta, nTop);
+			putShort(delta, nBottom);
+			putShort(delta, nLines);
+		}
+	}
+
+	for (int i = 0; i < size.getY(); i++)
+	{
+		SDLine_t &line = lines[i];
+
+		if (isSameLine(line, m_lines[i]))
+		{
+			continue;
+		}
+
+		//Text past the width of the screen is never shown.
+		size_t nSize = (line.text != NULL) ? line.text->size() : 0;
+
+		if (nSize > (size_t)size.getX())
+		{
+			nSize = size.getX();
+		}
+
+		delta.push_back(SD_OP_LINE);
+		putShort(delta, i + 1);
+		putShort(delta, nSize);
+
+		if (nSize > 0)
+		{
+			size_t nOffset = delta.size();
+
+			delta.resize(nOffset + nSize);
+			line.text->copy(&delta[nOffset], nSize);
+		}
+
+		putShort(delta, line.spans.size());
+
+		for (size_t j = 0; j < line.spans.size(); j++)
+		{
+			putShort(delta, line.spans[j].nLength);
+			delta.push_back(line.spans[j].foregroundColor);
+			delta.push_back(line.spans[j].backgroundColor);
+			delta.push_back(line.spans[j].nGraphicsMode);
+		}
+
+		releaseLine(m_lines[i]);
+		m_lines[i] = line;
+		m_lines[i].text = (line.text != NULL) ? line.text->clone() : new DataBuffer();
+	}
+
+	if (bFull || cursor.getX() != m_cursor.getX() || cursor.getY() != m_cursor.getY())
+	{
+		m_cursor = cursor;
+
+		delta.push_back(SD_OP_CURSOR);
+		putShort(delta, cursor.getX());
+		putShort(delta, cursor.getY());
+	}
+
+	m_bValid = true;
+
+	state->unlock();
+
+	return 0;
+}
+
+/**
+ * Reads a number. Returns -1 if the delta ends first.
+ */
+int ScreenDeltaDecoder::getShort(const unsigned char *&data, const unsigned char *end)
+{
+	if (end - data < 2)
+	{
+		return -1;
+	}
+
+	int nValue = data[0] | (data[1] << 8);
+
+	data += 2;
+
+	return nValue;
+}
+
+/**
+ * Replaces the text of a line of the display and drops its graphics states.
+ */
+void ScreenDeltaDecoder::setLine(TerminalState *state, int nLine, const char *text, size_t size)
+{
+	int nIndex = state->m_nTopBufferLine + nLine - 1;
+	DataBuffer *line = TerminalState::s_blankLine;
+
+	if (size > 0)
+	{
+		line = new DataBuffer();
+		line->append(text, size);
+		line->compact();
+	}
+
+	state->releaseBufferLine(state->m_data[nIndex]);
+	state->m_data[nIndex] = line;
+	state->removeGraphicsState(1, nLine, INT_MAX, nLine, NULL);
+}
+
+/**
+ * Scrolls the region the same way output would, so that lines scrolled off the top of the
+ * screen go to the history.
+ */
+void ScreenDeltaDecoder::scroll(TerminalState *state, int nTop, int nBottom, int nLines)
+{
+	Point cursorLoc = state->m_cursorLoc;
+	int nTopMargin = state->m_nTopMargin;
+	int nBottomMargin = state->m_nBottomMargin;
+
+	state->setMargin(nTop, nBottom);
+	state->setBufferTopLine(state->m_nTopBufferLine + nLines);
+	state->setMargin(nTopMargin, nBottomMargin);
+	state->m_cursorLoc = cursorLoc; //Setting the margins homes the cursor.
+}
+
+/**
+ * Applies a delta made by the encoder to the state. The state must have been brought to
+ * the screen the delta was made against, by the deltas before it.
+ * Returns -1 if the delta is invalid; the operations before the invalid one are applied.
+ * Returns 0 if success.
+ */
+int ScreenDeltaDecoder::apply(TerminalState *state, const char *data, size_t size)
+{
+	const unsigned char *next = (const unsigned char *)data;
+	const unsigned char *end = next + size;
+	bool bError = (state == NULL);
+
+	if (bError)
+	{
+		return -1;
+	}
+
+	state->lock();
+
+	while (next < end && !bError)
+	{
+		int nOp = *next++;
+		Point screenSize = state->getDisplayScreenSize();
+
+		switch (nOp)
+		{
+		case SD_OP_SIZE:
+		{
+			int nWidth = getShort(next, end);
+			int nHeight = getShort(next, end);
+
+			if (nWidth < 1 || nHeight < 1)
+			{
+				bError = true;
+				break;
+			}
+
+			state->resizeDisplayScreen(nWidth, nHeight);
+			state->setMargin(1, nHeight);
+			break;
+		}
+		case SD_OP_MODES:
+		{
+			int nModes = getShort(next, end);
+
+			if (nModes < 0)
+			{
+				bError = true;
+				break;
+			}
+
+			state->m_nTermModeFlags = (nModes & ~TS_TM_ORIGIN);
+			break;
+		}
+		case SD_OP_SCROLL:
+		{
+			int nTop = getShort(next, end);
+			int nBottom = getShort(next, end);
+			int nLines = getShort(next, end);
+
+			if (nLines >= 0x8000)
+			{
+				nLines -= 0x10000;
+			}
+
+			if (nTop < 1 || nBottom <= nTop || nBottom > screenSize.getY()
+				|| nLines == 0 || nLines > (nBottom - nTop) || nLines < (nTop - nBottom))
+			{
+				bError = true;
+				break;
+			}
+
+			scroll(state, nTop, nBottom, nLines);
+			break;
+		}
+		case SD_OP_LINE:
+		{
+			int nLine = getShort(next, end);
+			int nSize = getShort(next, end);
+
+			if (nLine < 1 || nLine > screenSize.getY() || nSize < 0 || (end - next) < nSize)
+			{
+				bError = true;
+				break;
+			}
+
+			setLine(state, nLine, (const char *)next, nSize);
+			next += nSize;
+
+			int nNumSpans = getShort(next, end);
+			int nColumn = 1;
+
+			if (nNumSpans < 0 || (end - next) < (nNumSpans * 5))
+			{
+				bError = true;
+				break;
+			}
+
+			for (int i = 0; i < nNumSpans; i++)
+			{
+				int nLength = getShort(next, end);
+				TSColor_t foregroundColor = (TSColor_t)next[0];
+				TSColor_t backgroundColor = (TSColor_t)next[1];
+				int nGraphicsMode = next[2];
+
+				next += 3;
+
+				if (foregroundColor >= TS_COLOR_MAX || backgroundColor >= TS_COLOR_MAX)
+				{
+					bError = true;
+					break;
+				}
+
+				state->addGraphicsState(nColumn, nLine, foregroundColor, backgroundColor, nGraphicsMode, TS_GM_OP_SET, false);
+				nColumn += nLength;
+			}
+			break;
+		}
+		case SD_OP_CURSOR:
+		{
+			int nX = getShort(next, end);
+			int nY = getShort(next, end);
+
+			//The cursor is past the last column while a wrap is pending.
+			if (nX < 1 || nY < 1 || nX > screenSize.getX() + 1 || nY > screenSize.getY())
+			{
+				bError = true;
+				break;
+			}
+
+			state->m_cursorLoc.setLocation(nX, nY);
+			break;
+		}
+		default:
+			bError = true;
+			break;
+		}
+	}
+
+	state->unlock();
+
+	if (bError)
+	{
+		Logger::getInstance()->error("Invalid screen delta.");
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCREENDELTA_HPP__
+#define SCREENDELTA_HPP__
+
+#include <vector>
+
+#include "terminalstate.hpp"
+
+/**
+ * Operations of a screen delta. Every operation starts with its type in one byte.
+ * Numbers are two bytes, little endian. Lines and columns start at 1.
+ */
+typedef enum
+{
+	SD_OP_SIZE = 1, //Width, height. Every line is sent again after it.
+	SD_OP_MODES, //Terminal mode flags.
+	SD_OP_SCROLL, //Top and bottom line of the region, then the lines scrolled up, negative for down.
+	SD_OP_LINE, //Line, size of the text, the text, number of spans, then the spans.
+	SD_OP_CURSOR, //Column, line.
+	SD_OP_MAX
+} SDOp_t;
+
+/**
+ * Columns sharing one graphics state. Sent as the number of columns, then the foreground
+ * color, background color and graphics mode in a byte each.
+ */
+typedef struct
+{
+	int nLength;
+	TSColor_t foregroundColor;
+	TSColor_t backgroundColor;
+	int nGraphicsMode;
+} SDSpan_t;
+
+/**
+ * A line of the screen as last sent.
+ */
+typedef struct
+{
+	DataBuffer *text; //NULL if the other side does not know the line.
+	unsigned int nHash;
+	bool bBlank;
+	std::vector<SDSpan_t> spans;
+} SDLine_t;
+
+/**
+ * Turns the changes to the screen of a terminal state into a compact delta against the
+ * screen it sent last: scrolls, lines changed as text with run length graphics states, and
+ * cursor moves. Lines are compared by hash first, so an unchanged screen costs a hash per line.
+ * Only the last screen sent is kept, so however much changed in between, the delta takes the
+ * other side straight to the current screen. Deltas must be applied in the order made.
+ */
+class ScreenDeltaEncoder
+{
+private:
+	std::vector<SDLine_t> m_lines;
+	std::vector<TSLineGraphicsState_t *> m_states; //Scratch space for the graphics states of a line.
+	std::vector<char> m_text; //Scratch space for the text of a line.
+	Point m_size;
+	Point m_cursor;
+	int m_nModes;
+	bool m_bValid; //False until the first delta, which sends the whole screen.
+
+	void getLine(TerminalState *state, int nLine, SDLine_t &line);
+	bool isSameLine(SDLine_t &line, SDLine_t &sent);
+	void releaseLine(SDLine_t &line);
+	int findScroll(std::vector<SDLine_t> &lines, int nTop, int nBottom);
+	void scroll(int nTop, int nBottom, int nLines);
+
+	static void putShort(std::vector<char> &delta, int nValue);
+
+public:
+	ScreenDeltaEncoder();
+	~ScreenDeltaEncoder();
+
+	int encode(TerminalState *state, std::vector<char> &delta);
+	void reset();
+};
+
+/**
+ * Applies screen deltas to a copy of the terminal state on the other side.
+ * Lines scrolled off the top go to the history of the copy, the same as they would by output.
+ */
+class ScreenDeltaDecoder
+{
+private:
+	static int getShort(const unsigned char *&data, const unsigned char *end);
+
+	static void setLine(TerminalState *state, int nLine, const char *text, size_t size);
+	static void scroll(TerminalState *state, int nTop, int nBottom, int nLines);
+
+public:
+	static int apply(TerminalState *state, const char *data, size_t size);
+};
+
+#endif
@@ -0,0 +1,361 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scrollbackindex.hpp"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+
+const int ScrollbackIndex::TRIGRAM_SIZE = 3;
+const int ScrollbackIndex::MIN_PRUNE_LINES = 1024;
+
+ScrollbackIndex::ScrollbackIndex()
+{
+	m_nFirstLine = 0;
+	m_nEndLine = 0;
+	m_nPrunedLine = 0;
+	m_nNumRanges = 0;
+
+	pthread_mutex_init(&m_rwLock, NULL);
+}
+
+ScrollbackIndex::~ScrollbackIndex()
+{
+	pthread_mutex_destroy(&m_rwLock);
+}
+
+/**
+ * Gets the case insensitive key of the three characters at the given location.
+ * Null characters are treated as blanks, the same way they are displayed.
+ */
+unsigned int ScrollbackIndex::getTrigram(const char *data)
+{
+	unsigned int nTrigram = 0;
+
+	for (int i = 0; i < TRIGRAM_SIZE; i++)
+	{
+		unsigned char c = (data[i] == '\0') ? ' ' : tolower((unsigned char)data[i]);
+
+		nTrigram = (nTrigram << 8) | c;
+	}
+
+	return nTrigram;
+}
+
+/**
+ * Adds a line to the ranges of a trigram. Ranges of evicted lines are dropped on the way.
+ * Must be called with the lock held.
+ */
+void ScrollbackIndex::addTrigram(unsigned int nTrigram, int64_t nLine)
+{
+	std::deque<SILineRange_t> &ranges = m_trigrams[nTrigram];
+
+	while (!ranges.empty() && ranges.front().nEnd <= m_nFirstLine)
+	{
+		ranges.pop_front();
+		m_nNumRanges--;
+	}
+
+	while (!ranges.empty() && ranges.back().nStart >= nLine)
+	{
+		ranges.pop_back();
+		m_nNumRanges--;
+	}
+
+	if (!ranges.empty() && ranges.back().nEnd > nLine)
+	{
+		ranges.back().nEnd = nLine;
+	}
+
+	if (!ranges.empty() && ranges.back().nEnd == nLine)
+	{
+		ranges.back().nEnd = nLine + 1;
+	}
+	else
+	{
+		SILineRange_t range;
+
+		range.nStart = nLine;
+		range.nEnd = nLine + 1;
+
+		ranges.push_back(range);
+		m_nNumRanges++;
+	}
+}
+
+/**
+ * Indexes the content of a line. Lines are expected to be added in order.
+ */
+void ScrollbackIndex::addLine(int64_t nLine, const char *data, size_t size)
+{
+	std::vector<unsigned int> trigrams;
+
+	if (data != NULL && size >= TRIGRAM_SIZE)
+	{
+		trigrams.reserve(size);
+
+		for (size_t i = 0; i + TRIGRAM_SIZE <= size; i++)
+		{
+			trigrams.push_back(getTrigram(data + i));
+		}
+
+		std::sort(trigrams.begin(), trigrams.end());
+		trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+	}
+
+	pthread_mutex_lock(&m_rwLock);
+
+	for (size_t i = 0; i < trigrams.size(); i++)
+	{
+		addTrigram(trigrams[i], nLine);
+	}
+
+	if (nLine >= m_nEndLine)
+	{
+		m_nEndLine = nLine + 1;
+	}
+
+	pthread_mutex_unlock(&m_rwLock);
+}
+
+/**
+ * Removes the specified line and all the lines after it.
+ * This only happens when history lines are pulled back into the display, which is rare,
+ * so the ranges are trimmed right away.
+ */
+void ScrollbackIndex::removeLinesFrom(int64_t nLine)
+{
+	pthread_mutex_lock(&m_rwLock);
+
+	if (nLine < m_nEndLine)
+	{
+		m_nEndLine = (nLine < m_nFirstLine) ? m_nFirstLine : nLine;
+		prune();
+	}
+
+	pthread_mutex_unlock(&m_rwLock);
+}
+
+/**
+ * Removes all the lines before the specified line.
+ */
+void ScrollbackIndex::removeLinesBefore(int64_t nLine)
+{
+	pthread_mutex_lock(&m_rwLock);
+
+	if (nLine > m_nFirstLine)
+	{
+		m_nFirstLine = nLine;
+
+		if (m_nEndLine < m_nFirstLine)
+		{
+			m_nEndLine = m_nFirstLine;
+		}
+
+		if ((m_nFirstLine - m_nPrunedLine) >= MIN_PRUNE_LINES)
+		{
+			prune();
+		}
+	}
+
+	pthread_mutex_unlock(&m_rwLock);
+}
+
+/**
+ * Releases the ranges of removed lines. Must be called with the lock held.
+ */
+void ScrollbackIndex::prune()
+{
+	std::map<unsigned int, std::deque<SILineRange_t> >::iterator itr = m_trigrams.begin();
+
+	while (itr != m_trigrams.end())
+	{
+		std::deque<SILineRange_t> &ranges = itr->second;
+
+		while (!ranges.empty() && ranges.front().nEnd <= m_nFirstLine)
+		{
+			ranges.pop_front();
+			m_nNumRanges--;
+		}
+
+		while (!ranges.empty() && ranges.back().nStart >= m_nEndLine)
+		{
+			ranges.pop_back();
+			m_nNumRanges--;
+		}
+
+		if (!ranges.empty() && ranges.back().nEnd > m_nEndLine)
+		{
+			ranges.back().nEnd = m_nEndLine;
+		}
+
+		if (ranges.empty())
+		{
+			m_trigrams.erase(itr++);
+		}
+		else
+		{
+			itr++;
+		}
+	}
+
+	m_nPrunedLine = m_nFirstLine;
+}
+
+/**
+ * Removes all the lines. Lines are then expected to be added from the specified line on,
+ * which may come before the lines that were removed.
+ */
+void ScrollbackIndex::clear(int64_t nFirstLine)
+{
+	pthread_mutex_lock(&m_rwLock);
+
+	m_trigrams.clear();
+	m_nNumRanges = 0;
+	m_nFirstLine = nFirstLine;
+	m_nEndLine = nFirstLine;
+	m_nPrunedLine = m_nFirstLine;
+
+	pthread_mutex_unlock(&m_rwLock);
+}
+
+/**
+ * Finds the ranges of lines that may contain the literal, ignoring case.
+ * Returns -1 if the literal is too short to use the index; every line is then a candidate.
+ * Returns 0 if success.
+ */
+int ScrollbackIndex::findCandidates(const char *sLiteral, size_t size, std::vector<SILineRange_t> &ranges)
+{
+	std::vector<unsigned int> trigrams;
+	std::vector<SILineRange_t> tmp;
+
+	ranges.clear();
+
+	if (sLiteral == NULL || size < TRIGRAM_SIZE)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i + TRIGRAM_SIZE <= size; i++)
+	{
+		trigrams.push_back(getTrigram(sLiteral + i));
+	}
+
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	pthread_mutex_lock(&m_rwLock);
+
+	for (size_t i = 0; i < trigrams.size(); i++)
+	{
+		std::map<unsigned int, std::deque<SILineRange_t> >::iterator locator = m_trigrams.find(trigrams[i]);
+
+		if (locator == m_trigrams.end())
+		{
+			ranges.clear();
+			break;
+		}
+
+		std::deque<SILineRange_t> &lines = locator->second;
+
+		if (i == 0)
+		{
+			//Start with the valid part of the first trigram.
+			for (std::deque<SILineRange_t>::iterator itr = lines.begin(); itr != lines.end(); itr++)
+			{
+				SILineRange_t range = *itr;
+
+				range.nStart = std::max(range.nStart, m_nFirstLine);
+				range.nEnd = std::min(range.nEnd, m_nEndLine);
+
+				if (range.nStart < range.nEnd)
+				{
+					ranges.push_back(range);
+				}
+			}
+		}
+		else
+		{
+			//Intersect the current result with the ranges of the trigram.
+			size_t j = 0;
+			std::deque<SILineRange_t>::iterator itr = lines.begin();
+
+			tmp.clear();
+
+			while (j < ranges.size() && itr != lines.end())
+			{
+				SILineRange_t range;
+
+				range.nStart = std::max(ranges[j].nStart, itr->nStart);
+				range.nEnd = std::min(ranges[j].nEnd, itr->nEnd);
+
+				if (range.nStart < range.nEnd)
+				{
+					tmp.push_back(range);
+				}
+
+				if (ranges[j].nEnd < itr->nEnd)
+				{
+					j++;
+				}
+				else
+				{
+					itr++;
+				}
+			}
+
+			ranges.swap(tmp);
+		}
+
+		if (ranges.empty())
+		{
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&m_rwLock);
+
+	return 0;
+}
+
+int64_t ScrollbackIndex::getFirstLine()
+{
+	return m_nFirstLine;
+}
+
+int64_t ScrollbackIndex::getEndLine()
+{
+	return m_nEndLine;
+}
+
+/**
+ * Gets an estimate of the number of bytes used by the index.
+ */
+size_t ScrollbackIndex::getMemoryUsage()
+{
+	pthread_mutex_lock(&m_rwLock);
+
+	size_t nBytes = (m_nNumRanges * sizeof(SILineRange_t))
+		+ (m_trigrams.size() * (sizeof(unsigned int) + sizeof(std::deque<SILineRange_t>) + 4 * sizeof(void *)));
+
+	pthread_mutex_unlock(&m_rwLock);
+
+	return nBytes;
+}
@@ -0,0 +1,82 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCROLLBACKINDEX_HPP__
+#define SCROLLBACKINDEX_HPP__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+/**
+ * A range of line numbers. Includes the start, but not the end.
+ */
+typedef struct
+{
+	int64_t nStart;
+	int64_t nEnd;
+} SILineRange_t;
+
+/**
+ * A thread safe trigram index over the history lines of a terminal state.
+ * Lines are identified by their line number, which keeps counting up as lines
+ * are added so that evicting old lines does not renumber the others. Line numbers
+ * are 64 bits, so a long running session does not run out of them.
+ * The index only narrows down the lines to look at; it may return lines that
+ * no longer contain the text, so every candidate must be verified.
+ */
+class ScrollbackIndex
+{
+private:
+	static const int MIN_PRUNE_LINES;
+
+	std::map<unsigned int, std::deque<SILineRange_t> > m_trigrams;
+	int64_t m_nFirstLine; //Lines before this one were evicted.
+	int64_t m_nEndLine; //One past the last valid line.
+	int64_t m_nPrunedLine; //First line at the time of the last full prune.
+	size_t m_nNumRanges;
+
+	pthread_mutex_t m_rwLock;
+
+	void addTrigram(unsigned int nTrigram, int64_t nLine);
+	void prune();
+
+public:
+	static const int TRIGRAM_SIZE;
+
+	ScrollbackIndex();
+	~ScrollbackIndex();
+
+	static unsigned int getTrigram(const char *data);
+
+	void addLine(int64_t nLine, const char *data, size_t size);
+	void removeLinesFrom(int64_t nLine);
+	void removeLinesBefore(int64_t nLine);
+	void clear(int64_t nFirstLine);
+
+	int findCandidates(const char *sLiteral, size_t size, std::vector<SILineRange_t> &ranges);
+	int64_t getFirstLine();
+	int64_t getEndLine();
+	size_t getMemoryUsage();
+};
+
+#endif
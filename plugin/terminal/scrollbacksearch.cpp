@@ -0,0 +1,435 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scrollbacksearch.hpp"
+
+#include "util/logger.hpp"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+const int ScrollbackSearch::INIT_LINE_SIZE = 256;
+
+ScrollbackSearch::ScrollbackSearch(TerminalState *state, ScrollbackSearchListener *listener)
+{
+	m_state = state;
+	m_listener = listener;
+	m_sPattern = NULL;
+	m_nFlags = SS_LITERAL;
+	m_line = NULL;
+	m_nLineSize = 0;
+	m_bCancel = false;
+	m_bRunning = false;
+	m_bStarted = false;
+}
+
+ScrollbackSearch::~ScrollbackSearch()
+{
+	cancel();
+	wait();
+
+	free(m_sPattern);
+	free(m_line);
+}
+
+/**
+ * Finds the longest run of characters that every match of the pattern must contain.
+ * Returns the length of the run, or 0 if there is none. The run is not null terminated.
+ */
+int ScrollbackSearch::getRequiredLiteral(const char *sPattern, int nFlags, char *dest, size_t size)
+{
+	int nBest = 0;
+	int nCurrent = 0;
+	int nDepth = 0;
+	char *current = NULL;
+
+	if (sPattern == NULL || dest == NULL || size == 0)
+	{
+		return 0;
+	}
+
+	if ((nFlags & SS_REGEX) == 0)
+	{
+		nBest = strlen(sPattern);
+		nBest = (nBest > size) ? size : nBest;
+		memcpy(dest, sPattern, nBest);
+		return nBest;
+	}
+
+	current = (char *)malloc(size);
+
+	if (current == NULL)
+	{
+		return 0;
+	}
+
+	for (const char *c = sPattern; *c != '\0'; c++)
+	{
+		bool bLiteral = false;
+		char literal = *c;
+
+		switch (*c)
+		{
+		case '|':
+			//Alternatives do not share a required run.
+			free(current);
+			return 0;
+		case '\\':
+			if (c[1] != '\0' && !isalnum((unsigned char)c[1]))
+			{
+				literal = *(++c);
+				bLiteral = true;
+			}
+			else if (c[1] != '\0')
+			{
+				c++;
+			}
+			break;
+		case '[':
+			//Skip the bracket expression. A leading ']' is part of the set.
+			c++;
+			if (*c == '^')
+			{
+				c++;
+			}
+			if (*c == ']')
+			{
+				c++;
+			}
+			while (*c != '\0' && *c != ']')
+			{
+				c++;
+			}
+			if (*c == '\0')
+			{
+				c--;
+			}
+			break;
+		case '(':
+			nDepth++;
+			break;
+		case ')':
+			nDepth--;
+			break;
+		case '{':
+			while (*c != '\0' && *c != '}')
+			{
+				c++;
+			}
+			if (*c == '\0')
+			{
+				c--;
+			}
+			break;
+		case '*':
+		case '?':
+		case '+':
+		case '.':
+		case '^':
+		case '$':
+			break;
+		default:
+			bLiteral = true;
+			break;
+		}
+
+		//A character followed by an optional quantifier is not required.
+		char next = c[1];
+		bool bOptional = (next == '*' || next == '?' || next == '{');
+
+		if (bLiteral && nDepth == 0 && !bOptional && nCurrent < size)
+		{
+			current[nCurrent++] = literal;
+
+			//The run goes on unless the character may repeat.
+			if (next != '+')
+			{
+				continue;
+			}
+		}
+
+		if (nCurrent > nBest)
+		{
+			nBest = nCurrent;
+			memcpy(dest, current, nBest);
+		}
+
+		nCurrent = 0;
+	}
+
+	if (nCurrent > nBest)
+	{
+		nBest = nCurrent;
+		memcpy(dest, current, nBest);
+	}
+
+	free(current);
+
+	return nBest;
+}
+
+/**
+ * Reads a line into the line buffer, growing it as needed. The result is null terminated.
+ * Returns the length of the line, or -1 if the line is no longer in the buffer.
+ */
+int ScrollbackSearch::readLine(int64_t nLineNumber)
+{
+	int nSize;
+
+	if (m_line == NULL)
+	{
+		m_nLineSize = INIT_LINE_SIZE;
+		m_line = (char *)malloc(m_nLineSize);
+
+		if (m_line == NULL)
+		{
+			return -1;
+		}
+	}
+
+	while ((nSize = m_state->getLineText(nLineNumber, m_line, m_nLineSize - 1)) == (m_nLineSize - 1))
+	{
+		char *line = (char *)realloc(m_line, m_nLineSize * 2);
+
+		if (line == NULL)
+		{
+			break;
+		}
+
+		m_line = line;
+		m_nLineSize *= 2;
+	}
+
+	if (nSize >= 0)
+	{
+		m_line[nSize] = '\0';
+
+		if ((m_nFlags & (SS_REGEX | SS_IGNORE_CASE)) == SS_IGNORE_CASE)
+		{
+			for (int i = 0; i < nSize; i++)
+			{
+				m_line[i] = tolower((unsigned char)m_line[i]);
+			}
+		}
+	}
+
+	return nSize;
+}
+
+/**
+ * Reports every match in the line. Returns the number of matches.
+ */
+int ScrollbackSearch::searchLine(int64_t nLineNumber)
+{
+	int nMatches = 0;
+	int nSize = readLine(nLineNumber);
+
+	if (nSize <= 0)
+	{
+		return 0;
+	}
+
+	if (m_nFlags & SS_REGEX)
+	{
+		regmatch_t match;
+		int nOffset = 0;
+
+		while (nOffset <= nSize && regexec(&m_regex, m_line + nOffset, 1, &match, (nOffset > 0) ? REG_NOTBOL : 0) == 0)
+		{
+			int nLength = match.rm_eo - match.rm_so;
+
+			m_listener->searchMatch(nLineNumber, nOffset + match.rm_so, nLength);
+			nMatches++;
+
+			nOffset += (nLength > 0) ? match.rm_eo : (match.rm_so + 1);
+		}
+	}
+	else
+	{
+		int nLength = strlen(m_sPattern);
+
+		for (char *c = strstr(m_line, m_sPattern); c != NULL; c = strstr(c + nLength, m_sPattern))
+		{
+			m_listener->searchMatch(nLineNumber, c - m_line, nLength);
+			nMatches++;
+		}
+	}
+
+	return nMatches;
+}
+
+/**
+ * Searches the lines from the end line down to the start line.
+ * Returns the number of matches.
+ */
+int ScrollbackSearch::searchLines(int64_t nStart, int64_t nEnd)
+{
+	int nMatches = 0;
+
+	for (int64_t i = nEnd - 1; i >= nStart && !m_bCancel; i--)
+	{
+		nMatches += searchLine(i);
+	}
+
+	return nMatches;
+}
+
+int ScrollbackSearch::runSearch()
+{
+	int nMatches = 0;
+	int64_t nFirstLine, nEndLine, nIndexEndLine;
+	char literal[256];
+	int nLiteralSize;
+	std::vector<SILineRange_t> candidates;
+	ScrollbackIndex *index;
+
+	m_state->lock();
+
+	nFirstLine = m_state->getFirstLineNumber();
+	nEndLine = nFirstLine + m_state->getBufferTopLineIndex() + m_state->getBufferScreenHeight();
+	index = m_state->getSearchIndex();
+	nIndexEndLine = nFirstLine;
+
+	nLiteralSize = getRequiredLiteral(m_sPattern, m_nFlags, literal, sizeof(literal));
+
+	if (index != NULL && index->findCandidates(literal, nLiteralSize, candidates) == 0)
+	{
+		nIndexEndLine = index->getEndLine();
+	}
+
+	m_state->unlock();
+
+	//Lines not covered by the index, including the display, are always looked at.
+	nMatches += searchLines(nIndexEndLine, nEndLine);
+
+	for (int i = candidates.size() - 1; i >= 0 && !m_bCancel; i--)
+	{
+		nMatches += searchLines(candidates[i].nStart, candidates[i].nEnd);
+	}
+
+	if (m_bCancel)
+	{
+		Logger::getInstance()->debug("Search cancelled after %d matches.", nMatches);
+	}
+
+	m_listener->searchDone(nMatches, m_bCancel);
+
+	if (m_nFlags & SS_REGEX)
+	{
+		regfree(&m_regex);
+	}
+
+	m_bRunning = false;
+
+	return 0;
+}
+
+void *ScrollbackSearch::searchThread(void *search)
+{
+	((ScrollbackSearch *)search)->runSearch();
+	pthread_exit(NULL);
+	return NULL;
+}
+
+/**
+ * Starts searching for the pattern in the background. Any previous search must be finished.
+ * Returns 0 if success, -1 if the pattern is invalid or a search is still running.
+ */
+int ScrollbackSearch::start(const char *sPattern, int nFlags)
+{
+	if (sPattern == NULL || m_state == NULL || m_listener == NULL || m_bRunning)
+	{
+		return -1;
+	}
+
+	wait();
+
+	free(m_sPattern);
+	m_sPattern = strdup(sPattern);
+	m_nFlags = nFlags;
+
+	if (m_sPattern == NULL || m_sPattern[0] == '\0')
+	{
+		return -1;
+	}
+
+	if (m_nFlags & SS_REGEX)
+	{
+		int nRegexFlags = REG_EXTENDED | ((m_nFlags & SS_IGNORE_CASE) ? REG_ICASE : 0);
+
+		if (regcomp(&m_regex, m_sPattern, nRegexFlags) != 0)
+		{
+			Logger::getInstance()->error("Invalid search pattern '%s'.", m_sPattern);
+			return -1;
+		}
+	}
+	else if (m_nFlags & SS_IGNORE_CASE)
+	{
+		for (char *c = m_sPattern; *c != '\0'; c++)
+		{
+			*c = tolower((unsigned char)*c);
+		}
+	}
+
+	m_bCancel = false;
+	m_bRunning = true;
+
+	if (pthread_create(&m_searchThread, NULL, searchThread, this) != 0)
+	{
+		m_bRunning = false;
+
+		if (m_nFlags & SS_REGEX)
+		{
+			regfree(&m_regex);
+		}
+
+		return -1;
+	}
+
+	m_bStarted = true;
+
+	return 0;
+}
+
+/**
+ * Stops the current search. The listener is still told when the search is done.
+ */
+void ScrollbackSearch::cancel()
+{
+	m_bCancel = true;
+}
+
+/**
+ * Waits for the current search to finish.
+ */
+void ScrollbackSearch::wait()
+{
+	if (m_bStarted)
+	{
+		pthread_join(m_searchThread, NULL);
+		m_bStarted = false;
+	}
+}
+
+bool ScrollbackSearch::isRunning()
+{
+	return m_bRunning;
+}
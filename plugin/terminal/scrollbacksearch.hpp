@@ -0,0 +1,89 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCROLLBACKSEARCH_HPP__
+#define SCROLLBACKSEARCH_HPP__
+
+#include "terminalstate.hpp"
+
+#include <pthread.h>
+#include <regex.h>
+
+typedef enum
+{
+	SS_LITERAL = 0,
+	SS_REGEX = 1,
+	SS_IGNORE_CASE = 2
+} SSFlag_t;
+
+/**
+ * Receives the results of a search. Called from the search thread.
+ */
+class ScrollbackSearchListener
+{
+public:
+	virtual ~ScrollbackSearchListener() {}
+
+	virtual void searchMatch(int64_t nLineNumber, int nColumn, int nLength) = 0;
+	virtual void searchDone(int nNumMatches, bool bCancelled) = 0;
+};
+
+/**
+ * Searches the buffer lines of a terminal state on a background thread.
+ * Matches are reported newest line first as they are found, so the first
+ * results show up before the whole history has been looked at.
+ */
+class ScrollbackSearch
+{
+private:
+	static const int INIT_LINE_SIZE;
+
+	TerminalState *m_state;
+	ScrollbackSearchListener *m_listener;
+
+	char *m_sPattern;
+	int m_nFlags;
+	regex_t m_regex;
+	char *m_line;
+	size_t m_nLineSize;
+
+	volatile bool m_bCancel;
+	volatile bool m_bRunning;
+	bool m_bStarted;
+	pthread_t m_searchThread;
+
+	int readLine(int64_t nLineNumber);
+	int searchLine(int64_t nLineNumber);
+	int searchLines(int64_t nStart, int64_t nEnd);
+
+	int runSearch();
+	static void *searchThread(void *search);
+
+public:
+	ScrollbackSearch(TerminalState *state, ScrollbackSearchListener *listener);
+	~ScrollbackSearch();
+
+	static int getRequiredLiteral(const char *sPattern, int nFlags, char *dest, size_t size);
+
+	int start(const char *sPattern, int nFlags);
+	void cancel();
+	void wait();
+	bool isRunning();
+};
+
+#endif
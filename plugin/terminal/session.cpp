@@ -0,0 +1,212 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "session.hpp"
+
+Session::Session()
+{
+	m_terminal = new Terminal();
+	m_state = new VTTerminalState();
+	m_listener = NULL;
+	m_recorder = NULL;
+}
+
+Session::~Session()
+{
+	stopRecording();
+
+	//Stops the terminal first, so the parser is done with the state.
+	delete m_terminal;
+	delete m_state;
+}
+
+/**
+ * Starts the child process of the session with a screen of the given size.
+ * Returns 0 if success.
+ */
+int Session::start(int nWidth, int nHeight)
+{
+	m_state->setDisplayScreenSize(nWidth, nHeight);
+	m_state->addTerminalModeFlags(TS_TM_AUTO_WRAP);
+
+	//Must set window size before starting the terminal.
+	m_terminal->setWindowSize(nWidth, nHeight);
+	m_terminal->setExtTerminal(this);
+	setReady(true);
+
+	return m_terminal->start();
+}
+
+/**
+ * Resizes the screen of the session and tells the child about it.
+ */
+void Session::resize(int nWidth, int nHeight)
+{
+	Point size = m_state->getDisplayScreenSize();
+
+	if (nWidth < 1 || nHeight < 1)
+	{
+		return;
+	}
+
+	if (size.getX() != nWidth || size.getY() != nHeight)
+	{
+		m_state->lock();
+
+		m_state->resizeDisplayScreen(nWidth, nHeight);
+
+		if (m_recorder != NULL)
+		{
+			m_recorder->recordResize(nWidth, nHeight);
+		}
+
+		m_state->unlock();
+	}
+
+	m_terminal->setWindowSize(nWidth, nHeight);
+}
+
+/**
+ * Parses output from the terminal into the state. Called from the parser thread.
+ * The output is recorded here rather than as it is read, so that keyframes of the state
+ * line up with the recorded output.
+ */
+void Session::insertData(const char *data, size_t size)
+{
+	if (size > 0)
+	{
+		m_state->lock();
+
+		if (m_recorder != NULL)
+		{
+			m_recorder->recordOutput(data, size);
+		}
+
+		if (m_listener != NULL)
+		{
+			m_listener->sessionOutput(this, data, size);
+		}
+
+		m_state->insertString(data, size, m_terminal);
+
+		if (m_recorder != NULL && m_recorder->isKeyframeDue() && !m_state->hasPendingSequence())
+		{
+			m_recorder->recordKeyframe(m_state);
+		}
+
+		if (m_listener != NULL)
+		{
+			m_listener->sessionUpdated(this);
+		}
+
+		m_state->unlock();
+	}
+}
+
+/**
+ * Tells the listener that the child exited. Called from the parser thread.
+ */
+void Session::childExited(int nStatus)
+{
+	m_state->lock();
+
+	if (m_listener != NULL)
+	{
+		m_listener->sessionExited(this, nStatus);
+	}
+
+	m_state->unlock();
+}
+
+/**
+ * Starts recording the output of the session to a file. Any previous recording is stopped.
+ * A binary log starts with a keyframe, so the screen is there even if the session was
+ * running for a while.
+ * Returns 0 if success.
+ */
+int Session::startRecording(const char *sFileName, SRFormat_t format)
+{
+	SessionRecorder *recorder = new SessionRecorder();
+	int nResult = -1;
+
+	stopRecording();
+
+	m_state->lock();
+
+	Point size = m_state->getDisplayScreenSize();
+
+	if (recorder->start(sFileName, format, size.getX(), size.getY()) == 0)
+	{
+		recorder->recordKeyframe(m_state);
+		m_recorder = recorder;
+		nResult = 0;
+	}
+
+	m_state->unlock();
+
+	if (nResult != 0)
+	{
+		delete recorder;
+	}
+
+	return nResult;
+}
+
+/**
+ * Stops recording and writes out what is left of the recording.
+ */
+void Session::stopRecording()
+{
+	SessionRecorder *recorder;
+
+	m_state->lock();
+	recorder = m_recorder;
+	m_recorder = NULL;
+	m_state->unlock();
+
+	delete recorder;
+}
+
+/**
+ * Gets the recorder of the session, or NULL if it is not recording.
+ */
+SessionRecorder *Session::getRecorder()
+{
+	return m_recorder;
+}
+
+Terminal *Session::getTerminal()
+{
+	return m_terminal;
+}
+
+VTTerminalState *Session::getState()
+{
+	return m_state;
+}
+
+/**
+ * Sets who is told about updates, or NULL for a session in the background.
+ * Once this returns, the previous listener is not called anymore.
+ */
+void Session::setListener(SessionListener *listener)
+{
+	m_state->lock();
+	m_listener = listener;
+	m_state->unlock();
+}
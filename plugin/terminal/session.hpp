@@ -0,0 +1,82 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSION_HPP__
+#define SESSION_HPP__
+
+#include "extterminal.hpp"
+#include "sessionrecorder.hpp"
+#include "terminal.hpp"
+#include "vtterminalstate.hpp"
+
+class Session;
+
+/**
+ * Told when the output of a session changed its terminal state. Called from the parser
+ * thread with the state locked.
+ */
+class SessionListener
+{
+public:
+	virtual ~SessionListener() {}
+
+	/**
+	 * Gets the output of the session just before it is parsed into the state.
+	 */
+	virtual void sessionOutput(Session *session, const char *data, size_t size) {}
+
+	virtual void sessionUpdated(Session *session) = 0;
+
+	/**
+	 * The child of the session exited and all of its output was parsed. The status is as
+	 * returned by waitpid, or -1 if it is unknown.
+	 */
+	virtual void sessionExited(Session *session, int nStatus) {}
+};
+
+/**
+ * A terminal and the state its output is parsed into. The state is kept up to date
+ * whether or not the session is shown, so switching to it only needs a redraw.
+ */
+class Session : public ExtTerminal
+{
+private:
+	Terminal *m_terminal;
+	VTTerminalState *m_state;
+	SessionListener *m_listener;
+	SessionRecorder *m_recorder;
+
+public:
+	Session();
+	virtual ~Session();
+
+	int start(int nWidth, int nHeight);
+	void resize(int nWidth, int nHeight);
+	void insertData(const char *data, size_t size);
+	void childExited(int nStatus);
+
+	int startRecording(const char *sFileName, SRFormat_t format);
+	void stopRecording();
+	SessionRecorder *getRecorder();
+
+	Terminal *getTerminal();
+	VTTerminalState *getState();
+	void setListener(SessionListener *listener);
+};
+
+#endif
@@ -0,0 +1,534 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sessionclient.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "screendelta.hpp"
+#include "sessionserver.hpp"
+#include "terminalsnapshot.hpp"
+#include "util/logger.hpp"
+
+SessionClient::SessionClient()
+{
+	m_nFD = -1;
+	m_nSession = -1;
+	m_bClosed = false;
+	m_nExitStatus = -1;
+	m_bDelta = false;
+	m_state = new VTTerminalState();
+	m_listener = NULL;
+	m_data = NULL;
+	m_nCapacity = 0;
+	m_bStarted = false;
+
+	pthread_mutex_init(&m_writeLock, NULL);
+}
+
+SessionClient::~SessionClient()
+{
+	close();
+
+	delete m_state;
+	free(m_data);
+
+	pthread_mutex_destroy(&m_writeLock);
+}
+
+/**
+ * Connects to the session server listening on the given socket.
+ * Returns 0 if success.
+ */
+int SessionClient::connect(const char *sPath)
+{
+	struct sockaddr_un address;
+
+	if (sPath == NULL || strlen(sPath) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, sPath);
+
+	m_nFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (m_nFD < 0 || ::connect(m_nFD, (struct sockaddr *)&address, sizeof(address)) != 0)
+	{
+		Logger::getInstance()->info("Cannot connect to session server '%s'.", sPath);
+		close();
+		return -1;
+	}
+
+	if (!SessionServer::isSameUser(m_nFD))
+	{
+		Logger::getInstance()->error("Session server '%s' runs as another user.", sPath);
+		close();
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Attaches to the session at the given index on the server, or to a new session if the
+ * index is negative, and waits for its snapshot. The session takes the given size.
+ * Output is parsed in the background from then on, or with deltas set, the state follows
+ * the screen deltas of the server, which skip the screens in between when the client is slow.
+ * Only one attach per connection.
+ * Returns 0 if success.
+ */
+int SessionClient::attach(int nSession, int nWidth, int nHeight, bool bDelta)
+{
+	unsigned char values[16];
+	int nType;
+	size_t size;
+
+	if (m_nFD < 0 || m_bStarted)
+	{
+		return -1;
+	}
+
+	SessionServer::putInt(values, nSession);
+	SessionServer::putInt(values + 4, nWidth);
+	SessionServer::putInt(values + 8, nHeight);
+	SessionServer::putInt(values + 12, bDelta ? SS_ATTACH_DELTA : SS_ATTACH_NONE);
+
+	m_bDelta = bDelta;
+
+	if (sendMessage(SS_MSG_ATTACH, (const char *)values, sizeof(values)) != 0)
+	{
+		return -1;
+	}
+
+	do
+	{
+		if (readMessage(nType, size) != 0 || nType == SS_MSG_ERROR)
+		{
+			Logger::getInstance()->error("Cannot attach to session %d.", nSession);
+			return -1;
+		}
+	}
+	while (nType != SS_MSG_SNAPSHOT);
+
+	if (loadSnapshot(size) != 0)
+	{
+		return -1;
+	}
+
+	setReady(true);
+
+	if (pthread_create(&m_readerThread, NULL, readerThread, this) != 0)
+	{
+		Logger::getInstance()->error("Cannot start session client thread.");
+		setReady(false);
+		return -1;
+	}
+
+	m_bStarted = true;
+
+	return 0;
+}
+
+/**
+ * Detaches from the session, which keeps running on the server.
+ */
+void SessionClient::close()
+{
+	setReady(false);
+
+	if (m_nFD >= 0)
+	{
+		//Wakes up the reader thread.
+		shutdown(m_nFD, SHUT_RDWR);
+	}
+
+	if (m_bStarted)
+	{
+		pthread_join(m_readerThread, NULL);
+		m_bStarted = false;
+	}
+
+	if (m_nFD >= 0)
+	{
+		::close(m_nFD);
+		m_nFD = -1;
+	}
+}
+
+int SessionClient::readFully(char *data, size_t size)
+{
+	while (size > 0)
+	{
+		ssize_t nResult = read(m_nFD, data, size);
+
+		if (nResult < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (nResult <= 0)
+		{
+			return -1;
+		}
+
+		data += nResult;
+		size -= nResult;
+	}
+
+	return 0;
+}
+
+/**
+ * Reads the next message from the server into the message buffer.
+ * Returns 0 if success.
+ */
+int SessionClient::readMessage(int &nType, size_t &size)
+{
+	unsigned char header[SessionServer::HEADER_SIZE];
+
+	if (readFully((char *)header, sizeof(header)) != 0)
+	{
+		return -1;
+	}
+
+	nType = header[0];
+	size = SessionServer::getInt(header + 1);
+
+	if (size > m_nCapacity)
+	{
+		char *data = (char *)realloc(m_data, size);
+
+		if (data == NULL)
+		{
+			return -1;
+		}
+
+		m_data = data;
+		m_nCapacity = size;
+	}
+
+	return readFully(m_data, size);
+}
+
+/**
+ * Sends a message to the server. Blocks until it is sent.
+ * Returns 0 if success.
+ */
+int SessionClient::sendMessage(int nType, const char *data, size_t size)
+{
+	unsigned char header[SessionServer::HEADER_SIZE];
+	struct iovec vectors[2];
+	struct msghdr message;
+	int nResult = 0;
+
+	if (m_nFD < 0 || size > SessionServer::MAX_MESSAGE_SIZE)
+	{
+		return -1;
+	}
+
+	header[0] = nType;
+	SessionServer::putInt(header + 1, size);
+
+	vectors[0].iov_base = header;
+	vectors[0].iov_len = sizeof(header);
+	vectors[1].iov_base = (void *)data;
+	vectors[1].iov_len = size;
+
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = vectors;
+	message.msg_iovlen = 2;
+
+	pthread_mutex_lock(&m_writeLock);
+
+	while (vectors[1].iov_len > 0 || vectors[0].iov_len > 0)
+	{
+		ssize_t nSent = sendmsg(m_nFD, &message, MSG_NOSIGNAL);
+
+		if (nSent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			nResult = -1;
+			break;
+		}
+
+		for (int i = 0; i < 2 && nSent > 0; i++)
+		{
+			size_t nUsed = ((size_t)nSent < vectors[i].iov_len) ? nSent : vectors[i].iov_len;
+
+			vectors[i].iov_base = (char *)vectors[i].iov_base + nUsed;
+			vectors[i].iov_len -= nUsed;
+			nSent -= nUsed;
+		}
+
+		message.msg_iov = (vectors[0].iov_len > 0) ? vectors : (vectors + 1);
+		message.msg_iovlen = (vectors[0].iov_len > 0) ? 2 : 1;
+	}
+
+	pthread_mutex_unlock(&m_writeLock);
+
+	return nResult;
+}
+
+/**
+ * Replaces the state with the snapshot in the message buffer.
+ * Returns 0 if success.
+ */
+int SessionClient::loadSnapshot(size_t size)
+{
+	FILE *file;
+	int nResult;
+
+	if (size < 4)
+	{
+		return -1;
+	}
+
+	file = fmemopen(m_data + 4, size - 4, "rb");
+
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	m_state->lock();
+
+	TerminalSnapshot snapshot(file);
+	nResult = snapshot.load(m_state);
+
+	if (nResult == 0)
+	{
+		m_nSession = SessionServer::getInt((const unsigned char *)m_data);
+
+		if (m_listener != NULL)
+		{
+			m_listener->clientUpdated(this);
+		}
+	}
+
+	m_state->unlock();
+
+	fclose(file);
+
+	if (nResult != 0)
+	{
+		Logger::getInstance()->error("Cannot load snapshot of session.");
+	}
+
+	return nResult;
+}
+
+void SessionClient::handleMessage(int nType, size_t size)
+{
+	const unsigned char *values = (const unsigned char *)m_data;
+
+	switch (nType)
+	{
+	case SS_MSG_OUTPUT:
+		m_state->lock();
+		m_state->insertString(m_data, size, NULL);
+
+		if (m_listener != NULL)
+		{
+			m_listener->clientUpdated(this);
+		}
+
+		m_state->unlock();
+		break;
+	case SS_MSG_RESIZE:
+		if (size >= 8)
+		{
+			m_state->lock();
+			m_state->resizeDisplayScreen(SessionServer::getInt(values), SessionServer::getInt(values + 4));
+
+			if (m_listener != NULL)
+			{
+				m_listener->clientUpdated(this);
+			}
+
+			m_state->unlock();
+		}
+		break;
+	case SS_MSG_SNAPSHOT:
+		loadSnapshot(size);
+		break;
+	case SS_MSG_DELTA:
+		m_state->lock();
+
+		if (ScreenDeltaDecoder::apply(m_state, m_data, size) == 0 && m_listener != NULL)
+		{
+			m_listener->clientUpdated(this);
+		}
+
+		m_state->unlock();
+
+		//The server sends the next delta once this one is applied.
+		sendMessage(SS_MSG_ACK, NULL, 0);
+		break;
+	default:
+		break;
+	}
+}
+
+void *SessionClient::readerThread(void *client)
+{
+	((SessionClient *)client)->runReader();
+
+	return NULL;
+}
+
+/**
+ * Parses what the server sends until the session ends or the connection is closed.
+ */
+int SessionClient::runReader()
+{
+	int nType;
+	size_t size;
+
+	while (readMessage(nType, size) == 0)
+	{
+		if (nType == SS_MSG_EXIT)
+		{
+			if (size >= 4)
+			{
+				m_nExitStatus = (int)SessionServer::getInt((const unsigned char *)m_data);
+			}
+
+			break;
+		}
+
+		handleMessage(nType, size);
+	}
+
+	m_bClosed = true;
+	setReady(false);
+
+	if (m_listener != NULL)
+	{
+		m_listener->clientClosed(this);
+	}
+
+	return 0;
+}
+
+/**
+ * Sends input to the session as if it was typed.
+ */
+void SessionClient::insertData(const char *data, size_t size)
+{
+	if (size > 0 && isReady())
+	{
+		sendMessage(SS_MSG_INPUT, data, size);
+	}
+}
+
+/**
+ * Pastes into the session. The server feeds large pastes to the child a chunk at a time.
+ */
+void SessionClient::pasteData(const char *data, size_t size, bool bBracketed)
+{
+	char *message;
+
+	if (size == 0 || !isReady())
+	{
+		return;
+	}
+
+	message = (char *)malloc(size + 1);
+
+	if (message != NULL)
+	{
+		message[0] = bBracketed ? 1 : 0;
+		memcpy(message + 1, data, size);
+
+		if (sendMessage(SS_MSG_PASTE, message, size + 1) != 0)
+		{
+			Logger::getInstance()->warn("Cannot send paste to session server.");
+		}
+
+		free(message);
+	}
+}
+
+/**
+ * Asks the server to resize the session. The state is resized once the server confirms.
+ */
+void SessionClient::setWindowSize(int nWidth, int nHeight)
+{
+	unsigned char values[8];
+
+	if (isReady())
+	{
+		SessionServer::putInt(values, nWidth);
+		SessionServer::putInt(values + 4, nHeight);
+
+		sendMessage(SS_MSG_RESIZE, (const char *)values, sizeof(values));
+	}
+}
+
+VTTerminalState *SessionClient::getState()
+{
+	return m_state;
+}
+
+/**
+ * Gets the index of the attached session on the server, or -1 if not attached.
+ */
+int SessionClient::getSession()
+{
+	return m_nSession;
+}
+
+/**
+ * Returns true once the session ended or the connection to the server was lost.
+ */
+bool SessionClient::isClosed()
+{
+	return m_bClosed;
+}
+
+/**
+ * Gets the status the child of the session exited with, as returned by waitpid.
+ * Returns -1 while the session runs, or if the connection was lost instead.
+ */
+int SessionClient::getExitStatus()
+{
+	return m_nExitStatus;
+}
+
+/**
+ * Sets who is told about updates. Once this returns, the previous listener is not called anymore.
+ */
+void SessionClient::setListener(SessionClientListener *listener)
+{
+	m_state->lock();
+	m_listener = listener;
+	m_state->unlock();
+}
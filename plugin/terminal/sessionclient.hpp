@@ -0,0 +1,97 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONCLIENT_HPP__
+#define SESSIONCLIENT_HPP__
+
+#include <pthread.h>
+
+#include "extterminal.hpp"
+#include "vtterminalstate.hpp"
+
+class SessionClient;
+
+/**
+ * Told when the state of a client changed. Called from the reader thread of the client,
+ * with the state locked.
+ */
+class SessionClientListener
+{
+public:
+	virtual ~SessionClientListener() {}
+
+	virtual void clientUpdated(SessionClient *client) = 0;
+
+	/**
+	 * The session ended or the server went away. Called without the state locked.
+	 */
+	virtual void clientClosed(SessionClient *client) {}
+};
+
+/**
+ * A front end connection to a session served by a SessionServer. The client keeps its own
+ * copy of the terminal state, which starts from the snapshot sent on attaching and parses
+ * the output of the session from then on, or applies screen deltas if attached for them.
+ * Input, pastes and resizes are sent to the server.
+ * Replies the state would send to the child are dropped, as the server replies already.
+ */
+class SessionClient : public ExtTerminal
+{
+private:
+	int m_nFD;
+	int m_nSession; //Index of the attached session on the server, or -1.
+	bool m_bClosed; //The session ended or the server went away.
+	int m_nExitStatus; //Status the child of the session exited with, or -1.
+	bool m_bDelta; //The state follows screen deltas instead of parsing the output.
+	VTTerminalState *m_state;
+	SessionClientListener *m_listener;
+	char *m_data; //Last message read.
+	size_t m_nCapacity;
+	bool m_bStarted;
+	pthread_t m_readerThread;
+	pthread_mutex_t m_writeLock; //Mutex lock for sending messages.
+
+	int readFully(char *data, size_t size);
+	int readMessage(int &nType, size_t &size);
+	int sendMessage(int nType, const char *data, size_t size);
+	int loadSnapshot(size_t size);
+	void handleMessage(int nType, size_t size);
+
+	int runReader();
+	static void *readerThread(void *client);
+
+public:
+	SessionClient();
+	virtual ~SessionClient();
+
+	int connect(const char *sPath);
+	int attach(int nSession, int nWidth, int nHeight, bool bDelta = false);
+	void close();
+
+	void insertData(const char *data, size_t size);
+	void pasteData(const char *data, size_t size, bool bBracketed);
+	void setWindowSize(int nWidth, int nHeight);
+
+	VTTerminalState *getState();
+	int getSession();
+	bool isClosed();
+	int getExitStatus();
+	void setListener(SessionClientListener *listener);
+};
+
+#endif
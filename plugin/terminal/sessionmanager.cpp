@@ -0,0 +1,716 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sessionmanager.hpp"
+
+#include <sys/time.h>
+
+#include <algorithm>
+
+#include "session.hpp"
+#include "terminal.hpp"
+#include "util/logger.hpp"
+
+const long SessionManager::PARSER_WAIT_NSEC = (10 * 1000 * 1000);
+const long SessionManager::EXIT_POLL_NSEC = (250 * 1000 * 1000);
+
+SessionManager::SessionManager()
+{
+	m_nNextParse = 0;
+	m_nPoolSize = 0;
+	m_nPoolWidth = 80;
+	m_nPoolHeight = 24;
+	m_command = NULL;
+	m_readingTerminal = NULL;
+	m_parsingTerminal = NULL;
+	m_backend = NULL;
+	m_bDone = false;
+	m_bStarted = false;
+
+	pthread_mutex_init(&m_lock, NULL);
+	pthread_cond_init(&m_parserCond, NULL);
+	pthread_cond_init(&m_idleCond, NULL);
+}
+
+SessionManager::~SessionManager()
+{
+	std::vector<Session *> sessions;
+
+	pthread_mutex_lock(&m_lock);
+
+	m_nPoolSize = 0;
+	sessions.swap(m_sessions);
+	sessions.insert(sessions.end(), m_pool.begin(), m_pool.end());
+	m_pool.clear();
+
+	pthread_mutex_unlock(&m_lock);
+
+	deleteSessions(sessions);
+
+	//Terminals that are not part of a session are still owned by the caller. They are
+	//removed while the reader thread runs, so that I/O in flight on them is cancelled.
+	while (!m_terminals.empty())
+	{
+		removeTerminal(m_terminals.back());
+	}
+
+	if (m_bStarted)
+	{
+		pthread_mutex_lock(&m_lock);
+		m_bDone = true;
+		pthread_cond_signal(&m_parserCond);
+		pthread_mutex_unlock(&m_lock);
+
+		wakeReader();
+
+		pthread_join(m_readerThread, NULL);
+		pthread_join(m_parserThread, NULL);
+	}
+
+	if (m_backend != NULL)
+	{
+		delete m_backend;
+	}
+
+	pthread_mutex_destroy(&m_lock);
+	pthread_cond_destroy(&m_parserCond);
+	pthread_cond_destroy(&m_idleCond);
+}
+
+/**
+ * Sets up the I/O backend and starts the reader and parser threads.
+ * Returns 0 if success.
+ */
+int SessionManager::start(PBBackend_t backend)
+{
+	m_backend = PTYBackend::create(backend, this);
+
+	if (m_backend == NULL)
+	{
+		Logger::getInstance()->error("Cannot set up pseudo terminal I/O.");
+		return -1;
+	}
+
+	if (pthread_create(&m_readerThread, NULL, readerThread, this) != 0)
+	{
+		Logger::getInstance()->error("Cannot start reader thread.");
+		return -1;
+	}
+
+	if (pthread_create(&m_parserThread, NULL, parserThread, this) != 0)
+	{
+		Logger::getInstance()->error("Cannot start parser thread.");
+
+		m_bDone = true;
+		wakeReader();
+		pthread_join(m_readerThread, NULL);
+		return -1;
+	}
+
+	m_bStarted = true;
+
+	fillPool();
+
+	return 0;
+}
+
+PTYBackend *SessionManager::getBackend()
+{
+	return m_backend;
+}
+
+bool SessionManager::isDone()
+{
+	return m_bDone;
+}
+
+/**
+ * Interrupts the reader thread if it is waiting for output.
+ */
+void SessionManager::wakeReader()
+{
+	if (m_backend != NULL)
+	{
+		m_backend->wake();
+	}
+}
+
+/**
+ * Tells the parser thread that there may be output to parse.
+ */
+void SessionManager::wakeParser()
+{
+	pthread_mutex_lock(&m_lock);
+	pthread_cond_signal(&m_parserCond);
+	pthread_mutex_unlock(&m_lock);
+}
+
+/**
+ * Starts driving a terminal that was started. The terminal is not owned by the manager.
+ * Returns 0 if success.
+ */
+int SessionManager::addTerminal(Terminal *terminal)
+{
+	int result = 0;
+
+	if (terminal == NULL || !terminal->isReady() || m_backend == NULL)
+	{
+		return -1;
+	}
+
+	pthread_mutex_lock(&m_lock);
+
+	m_terminals.push_back(terminal);
+
+	pthread_mutex_lock(&terminal->m_writeLock);
+	pthread_mutex_lock(&terminal->m_pipelineLock);
+
+	terminal->m_manager = this;
+	terminal->updateMasterEvents();
+
+	if (terminal->m_nMasterEvents == 0)
+	{
+		terminal->m_manager = NULL;
+		m_terminals.pop_back();
+		result = -1;
+	}
+
+	pthread_mutex_unlock(&terminal->m_pipelineLock);
+	pthread_mutex_unlock(&terminal->m_writeLock);
+
+	pthread_mutex_unlock(&m_lock);
+
+	return result;
+}
+
+/**
+ * Stops driving a terminal. Waits for the reader and parser threads, and any I/O in flight,
+ * to be done with it, so it must not be called from either thread.
+ */
+void SessionManager::removeTerminal(Terminal *terminal)
+{
+	pthread_mutex_lock(&m_lock);
+
+	std::vector<Terminal *>::iterator itr = std::find(m_terminals.begin(), m_terminals.end(), terminal);
+
+	if (itr != m_terminals.end())
+	{
+		m_terminals.erase(itr);
+
+		while (m_readingTerminal == terminal || m_parsingTerminal == terminal)
+		{
+			pthread_cond_wait(&m_idleCond, &m_lock);
+		}
+
+		pthread_mutex_lock(&terminal->m_pipelineLock);
+
+		if (terminal->m_nMasterEvents != 0)
+		{
+			m_backend->setEvents(terminal, 0);
+			terminal->m_nMasterEvents = 0;
+		}
+
+		terminal->m_manager = NULL;
+
+		pthread_mutex_unlock(&terminal->m_pipelineLock);
+
+		while (m_bStarted && m_backend->isBusy(terminal))
+		{
+			pthread_cond_wait(&m_idleCond, &m_lock);
+		}
+	}
+
+	pthread_mutex_unlock(&m_lock);
+}
+
+/**
+ * Sets the NULL terminated command that sessions run when they are not given one. The command
+ * must stay valid while the manager runs. NULL logs in as the user, which is the default.
+ * Sessions already in the pool keep running the command they were started with.
+ */
+void SessionManager::setCommand(const char *const *command)
+{
+	m_command = command;
+}
+
+/**
+ * Sets how many idle sessions of the default command are kept ready. The pool is filled once
+ * the manager is started, and again every time a session is taken from it.
+ */
+void SessionManager::setPoolSize(int nSize)
+{
+	std::vector<Session *> extra;
+
+	pthread_mutex_lock(&m_lock);
+
+	m_nPoolSize = (nSize < 0) ? 0 : nSize;
+
+	while ((int)m_pool.size() > m_nPoolSize)
+	{
+		extra.push_back(m_pool.back());
+		m_pool.pop_back();
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	deleteSessions(extra);
+
+	fillPool();
+}
+
+int SessionManager::getPoolSize()
+{
+	return m_nPoolSize;
+}
+
+/**
+ * Starts a session and has it driven, without adding it to the sessions.
+ * Returns NULL if the session cannot be started.
+ */
+Session *SessionManager::startSession(int nWidth, int nHeight, const char *const *command)
+{
+	Session *session = new Session();
+
+	session->getTerminal()->setCommand(command);
+
+	if (session->start(nWidth, nHeight) != 0 || addTerminal(session->getTerminal()) != 0)
+	{
+		Logger::getInstance()->error("Cannot start session.");
+		delete session;
+		return NULL;
+	}
+
+	return session;
+}
+
+/**
+ * Takes the oldest session out of the pool. Sessions whose child exited while they waited
+ * are dropped.
+ * Returns NULL if the pool has no session left.
+ */
+Session *SessionManager::claimPoolSession()
+{
+	std::vector<Session *> exited;
+	Session *session = NULL;
+
+	pthread_mutex_lock(&m_lock);
+
+	while (session == NULL && !m_pool.empty())
+	{
+		session = m_pool.front();
+		m_pool.erase(m_pool.begin());
+
+		if (session->getTerminal()->hasExited())
+		{
+			exited.push_back(session);
+			session = NULL;
+		}
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	deleteSessions(exited);
+
+	return session;
+}
+
+/**
+ * Deletes sessions that are not used any more. All of their terminals are hung up before
+ * any child is waited for, so that the children exit together instead of one after another.
+ */
+void SessionManager::deleteSessions(const std::vector<Session *> &sessions)
+{
+	std::vector<Terminal *> terminals;
+
+	for (size_t i = 0; i < sessions.size(); i++)
+	{
+		terminals.push_back(sessions[i]->getTerminal());
+		terminals.back()->hangUp();
+	}
+
+	Terminal::stopChildren(terminals);
+
+	for (size_t i = 0; i < sessions.size(); i++)
+	{
+		delete sessions[i];
+	}
+}
+
+/**
+ * Starts sessions until the pool is full. Does nothing until the manager is started.
+ */
+void SessionManager::fillPool()
+{
+	pthread_mutex_lock(&m_lock);
+	int nNumMissing = m_bStarted ? (m_nPoolSize - (int)m_pool.size()) : 0;
+	int nWidth = m_nPoolWidth;
+	int nHeight = m_nPoolHeight;
+	pthread_mutex_unlock(&m_lock);
+
+	for (int i = 0; i < nNumMissing; i++)
+	{
+		Session *session = startSession(nWidth, nHeight, m_command);
+
+		if (session == NULL)
+		{
+			break;
+		}
+
+		pthread_mutex_lock(&m_lock);
+		m_pool.push_back(session);
+		pthread_mutex_unlock(&m_lock);
+	}
+}
+
+/**
+ * Starts a new session with its own child process and terminal state. The child runs the
+ * given NULL terminated command, or the default command if there is none. Sessions of the
+ * default command come from the pool when it has one ready; the pool then starts a replacement.
+ * Returns NULL if the session cannot be started.
+ */
+Session *SessionManager::createSession(int nWidth, int nHeight, const char *const *command)
+{
+	Session *session = NULL;
+
+	if (command == NULL)
+	{
+		pthread_mutex_lock(&m_lock);
+		m_nPoolWidth = nWidth;
+		m_nPoolHeight = nHeight;
+		pthread_mutex_unlock(&m_lock);
+
+		session = claimPoolSession();
+
+		if (session != NULL)
+		{
+			session->resize(nWidth, nHeight);
+		}
+	}
+
+	if (session == NULL)
+	{
+		session = startSession(nWidth, nHeight, (command != NULL) ? command : m_command);
+	}
+
+	if (session != NULL)
+	{
+		pthread_mutex_lock(&m_lock);
+		m_sessions.push_back(session);
+		pthread_mutex_unlock(&m_lock);
+	}
+
+	if (command == NULL)
+	{
+		fillPool();
+	}
+
+	return session;
+}
+
+/**
+ * Stops and deletes a session. Its listener gets no more updates after this returns.
+ */
+void SessionManager::closeSession(Session *session)
+{
+	pthread_mutex_lock(&m_lock);
+
+	std::vector<Session *>::iterator itr = std::find(m_sessions.begin(), m_sessions.end(), session);
+
+	if (itr == m_sessions.end())
+	{
+		pthread_mutex_unlock(&m_lock);
+		return;
+	}
+
+	m_sessions.erase(itr);
+
+	pthread_mutex_unlock(&m_lock);
+
+	delete session;
+}
+
+int SessionManager::getNumSessions()
+{
+	pthread_mutex_lock(&m_lock);
+	int nNumSessions = m_sessions.size();
+	pthread_mutex_unlock(&m_lock);
+
+	return nNumSessions;
+}
+
+/**
+ * Gets the session at the given index, in the order the sessions were created.
+ * Returns NULL if there is no such session.
+ */
+Session *SessionManager::getSession(int nIndex)
+{
+	Session *session = NULL;
+
+	pthread_mutex_lock(&m_lock);
+
+	if (nIndex >= 0 && nIndex < (int)m_sessions.size())
+	{
+		session = m_sessions[nIndex];
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return session;
+}
+
+bool SessionManager::isManaged(Terminal *terminal)
+{
+	return (std::find(m_terminals.begin(), m_terminals.end(), terminal) != m_terminals.end());
+}
+
+/**
+ * Reads again from the terminals that were paused, once the parser drained their ring
+ * down to the low watermark.
+ * Must be called with the lock held.
+ */
+void SessionManager::resumeTerminals()
+{
+	for (size_t i = 0; i < m_terminals.size(); i++)
+	{
+		Terminal *terminal = m_terminals[i];
+
+		if (terminal->m_bReadPaused && terminal->canResumeReading())
+		{
+			terminal->resumeReading();
+		}
+	}
+}
+
+/**
+ * Resumes the terminals that were waiting for room. Called from the backend when the
+ * reader thread is woken up.
+ */
+void SessionManager::handleWake()
+{
+	pthread_mutex_lock(&m_lock);
+	resumeTerminals();
+	pthread_mutex_unlock(&m_lock);
+}
+
+/**
+ * Claims a terminal for I/O on the reader thread, so that it is not removed meanwhile.
+ * Returns false if the terminal was removed; backends then leave it alone.
+ */
+bool SessionManager::beginIO(Terminal *terminal)
+{
+	bool bManaged;
+
+	pthread_mutex_lock(&m_lock);
+
+	bManaged = isManaged(terminal);
+
+	if (bManaged)
+	{
+		m_readingTerminal = terminal;
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return bManaged;
+}
+
+/**
+ * Releases the terminal claimed by beginIO(). Also called by backends once they no longer
+ * use a terminal's memory, since a removal may be waiting for that.
+ */
+void SessionManager::endIO()
+{
+	pthread_mutex_lock(&m_lock);
+	m_readingTerminal = NULL;
+	pthread_cond_broadcast(&m_idleCond);
+	pthread_mutex_unlock(&m_lock);
+}
+
+/**
+ * Does the reads and writes of one terminal whose master is ready, and reaps its child once
+ * it exited. Called from a backend that waits for readiness. Events left over for a terminal
+ * that was removed in the meantime are ignored.
+ */
+void SessionManager::handleEvents(Terminal *terminal, int nEvents)
+{
+	if (!beginIO(terminal))
+	{
+		return;
+	}
+
+	if ((nEvents & PB_WRITE) != 0)
+	{
+		pthread_mutex_lock(&terminal->m_writeLock);
+		terminal->writeMaster();
+		pthread_mutex_unlock(&terminal->m_writeLock);
+	}
+
+	if ((nEvents & PB_READ) != 0)
+	{
+		terminal->readMaster();
+	}
+
+	if ((nEvents & PB_EXIT) != 0)
+	{
+		terminal->reapChild();
+	}
+
+	endIO();
+}
+
+/**
+ * Passes the result of an asynchronous read or write to its terminal, or reaps its child once
+ * the wait for it to exit completed. Called from a backend that completes I/O itself. Results
+ * for a terminal that was removed are dropped.
+ */
+void SessionManager::handleCompletion(Terminal *terminal, int nEvent, int nResult)
+{
+	if (beginIO(terminal))
+	{
+		if (nEvent == PB_READ)
+		{
+			terminal->completeRead(nResult);
+		}
+		else if (nEvent == PB_EXIT)
+		{
+			terminal->reapChild();
+		}
+		else
+		{
+			terminal->completeWrite(nResult);
+		}
+	}
+
+	endIO();
+}
+
+/**
+ * Runs the I/O backend until the manager stops.
+ */
+int SessionManager::runReader()
+{
+	return m_backend->run();
+}
+
+void *SessionManager::readerThread(void *manager)
+{
+	((SessionManager *)manager)->runReader();
+	pthread_exit(NULL);
+	return NULL;
+}
+
+/**
+ * Parses the output queued by the reader thread into each terminal's external terminal,
+ * taking turns so that one busy session cannot hold up the others. Output is held in the
+ * ring until an external terminal is ready to take it. Sessions in the background are
+ * parsed the same way; they are just not drawn. Once a child exited and its last output
+ * was parsed, the external terminal is told.
+ */
+int SessionManager::runParser()
+{
+	struct timeval now;
+	struct timespec timeout;
+
+	pthread_mutex_lock(&m_lock);
+
+	while (!m_bDone)
+	{
+		Terminal *terminal = NULL;
+		bool bWaiting = false;
+		bool bPolling = false;
+		bool bExited = false;
+		size_t nNumTerminals = m_terminals.size();
+
+		for (size_t i = 0; i < nNumTerminals && terminal == NULL; i++)
+		{
+			size_t nIndex = (m_nNextParse + i) % nNumTerminals;
+
+			if (m_terminals[nIndex]->hasOutput())
+			{
+				terminal = m_terminals[nIndex];
+				m_nNextParse = nIndex + 1;
+			}
+			else if (m_terminals[nIndex]->m_readBuffer->size() > 0)
+			{
+				bWaiting = true;
+			}
+			else if (m_terminals[nIndex]->isExitPending())
+			{
+				terminal = m_terminals[nIndex];
+				bExited = true;
+			}
+			else if (m_terminals[nIndex]->isExitPolled())
+			{
+				bPolling = true;
+			}
+		}
+
+		if (terminal == NULL)
+		{
+			if (bWaiting || bPolling)
+			{
+				//Check again shortly for output that has nowhere to go yet, or for a child
+				//that exited without a pidfd to tell.
+				gettimeofday(&now, NULL);
+				timeout.tv_sec = now.tv_sec;
+				timeout.tv_nsec = (now.tv_usec * 1000) + (bWaiting ? PARSER_WAIT_NSEC : EXIT_POLL_NSEC);
+
+				if (timeout.tv_nsec >= 1000000000L)
+				{
+					timeout.tv_sec++;
+					timeout.tv_nsec -= 1000000000L;
+				}
+
+				pthread_cond_timedwait(&m_parserCond, &m_lock, &timeout);
+			}
+			else
+			{
+				pthread_cond_wait(&m_parserCond, &m_lock);
+			}
+
+			continue;
+		}
+
+		m_parsingTerminal = terminal;
+		pthread_mutex_unlock(&m_lock);
+
+		if (bExited)
+		{
+			terminal->reportExit();
+		}
+		else
+		{
+			terminal->parseOutput();
+		}
+
+		pthread_mutex_lock(&m_lock);
+		m_parsingTerminal = NULL;
+		pthread_cond_broadcast(&m_idleCond);
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return 0;
+}
+
+void *SessionManager::parserThread(void *manager)
+{
+	((SessionManager *)manager)->runParser();
+	pthread_exit(NULL);
+	return NULL;
+}
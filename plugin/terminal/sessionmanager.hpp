@@ -0,0 +1,105 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONMANAGER_HPP__
+#define SESSIONMANAGER_HPP__
+
+#include <pthread.h>
+
+#include <vector>
+
+#include "ptybackend.hpp"
+
+class Session;
+class Terminal;
+
+/**
+ * Drives any number of terminals with two threads. The reader thread runs the I/O backend,
+ * which waits on all the masters at once and does their reads and writes. The parser thread
+ * takes turns parsing the output of each terminal, so a busy terminal cannot starve the others.
+ * Sessions of the default command can be started ahead of time and kept idle in a pool, so
+ * that a new session shows its prompt at once instead of waiting for the shell to start up.
+ */
+class SessionManager
+{
+private:
+	static const long PARSER_WAIT_NSEC;
+	static const long EXIT_POLL_NSEC;
+
+	std::vector<Terminal *> m_terminals;
+	std::vector<Session *> m_sessions;
+	std::vector<Session *> m_pool; //Idle sessions started ahead of time, oldest first.
+	int m_nPoolSize;
+	int m_nPoolWidth; //Size of the last session asked for, which the pool sessions start at.
+	int m_nPoolHeight;
+	const char *const *m_command; //Command of new sessions that are not given one. NULL to log in.
+	size_t m_nNextParse; //Index of the terminal the parser looks at first.
+	Terminal *m_readingTerminal; //Terminal the reader thread is working on.
+	Terminal *m_parsingTerminal; //Terminal the parser thread is working on.
+
+	PTYBackend *m_backend;
+	bool m_bDone;
+	bool m_bStarted;
+	pthread_t m_readerThread;
+	pthread_t m_parserThread;
+	pthread_mutex_t m_lock; //Mutex lock for the terminals and sessions.
+	pthread_cond_t m_parserCond; //Signalled when there may be output to parse.
+	pthread_cond_t m_idleCond; //Signalled when a thread is done with a terminal.
+
+	bool isManaged(Terminal *terminal);
+	void resumeTerminals();
+	Session *startSession(int nWidth, int nHeight, const char *const *command);
+	Session *claimPoolSession();
+	void deleteSessions(const std::vector<Session *> &sessions);
+	void fillPool();
+
+	int runReader();
+	int runParser();
+	static void *readerThread(void *manager);
+	static void *parserThread(void *manager);
+
+public:
+	SessionManager();
+	~SessionManager();
+
+	int start(PBBackend_t backend = PB_BACKEND_AUTO);
+	PTYBackend *getBackend();
+	bool isDone();
+	void wakeReader();
+	void wakeParser();
+
+	bool beginIO(Terminal *terminal);
+	void endIO();
+	void handleWake();
+	void handleEvents(Terminal *terminal, int nEvents);
+	void handleCompletion(Terminal *terminal, int nEvent, int nResult);
+
+	int addTerminal(Terminal *terminal);
+	void removeTerminal(Terminal *terminal);
+
+	void setCommand(const char *const *command);
+	void setPoolSize(int nSize);
+	int getPoolSize();
+
+	Session *createSession(int nWidth, int nHeight, const char *const *command = NULL);
+	void closeSession(Session *session);
+	int getNumSessions();
+	Session *getSession(int nIndex);
+};
+
+#endif
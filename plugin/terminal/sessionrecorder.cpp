@@ -0,0 +1,824 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sessionrecorder.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "terminalsnapshot.hpp"
+#include "util/logger.hpp"
+
+const unsigned int SessionRecorder::MAGIC = 0x43525758; //"XWRC"
+const int SessionRecorder::VERSION = 1;
+const size_t SessionRecorder::FILE_HEADER_SIZE = 24;
+const size_t SessionRecorder::RECORD_HEADER_SIZE = 13;
+const unsigned int SessionRecorder::INDEX_MAGIC = 0x49525758; //"XWRI"
+const size_t SessionRecorder::TRAILER_SIZE = 12;
+const size_t SessionRecorder::MAX_PENDING_SIZE = (4 * 1024 * 1024);
+const size_t SessionRecorder::FLUSH_SIZE = (64 * 1024);
+const long SessionRecorder::FLUSH_INTERVAL_NSEC = (200 * 1000 * 1000);
+const uint64_t SessionRecorder::COALESCE_USEC = (10 * 1000);
+const size_t SessionRecorder::KEYFRAME_BYTES = (256 * 1024);
+const uint64_t SessionRecorder::KEYFRAME_INTERVAL_USEC = (250 * 1000);
+const int SessionRecorder::KEYFRAME_HISTORY_LINES = 1000;
+
+static void putInt(unsigned char *buffer, unsigned int nValue)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		buffer[i] = (nValue >> (i * 8)) & 0xFF;
+	}
+}
+
+static void putInt64(unsigned char *buffer, uint64_t nValue)
+{
+	putInt(buffer, nValue & 0xFFFFFFFF);
+	putInt(buffer + 4, (nValue >> 32) & 0xFFFFFFFF);
+}
+
+static unsigned int getInt(const unsigned char *buffer)
+{
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((unsigned int)buffer[3] << 24);
+}
+
+/**
+ * Gets the length of the UTF-8 sequence started by the given byte, or 0 if it cannot
+ * start one.
+ */
+static size_t getUTF8Length(unsigned char c)
+{
+	if (c >= 0xC2 && c <= 0xDF)
+	{
+		return 2;
+	}
+	else if (c >= 0xE0 && c <= 0xEF)
+	{
+		return 3;
+	}
+	else if (c >= 0xF0 && c <= 0xF4)
+	{
+		return 4;
+	}
+
+	return 0;
+}
+
+static bool isUTF8Continuation(unsigned char c)
+{
+	return ((c & 0xC0) == 0x80);
+}
+
+SessionRecorder::SessionRecorder()
+{
+	m_fd = -1;
+	m_format = SR_FORMAT_BINARY;
+	memset(&m_startTime, 0, sizeof(m_startTime));
+	m_bRecording = false;
+	m_bStopping = false;
+	m_bWriteError = false;
+
+	memset(&m_pending, 0, sizeof(m_pending));
+	memset(&m_writing, 0, sizeof(m_writing));
+	memset(&m_text, 0, sizeof(m_text));
+	m_nLastRecord = 0;
+	m_bCoalesce = false;
+	m_nLastTime = 0;
+	m_nUTF8TailSize = 0;
+
+	m_nFileOffset = 0;
+	m_nKeyframeBytes = 0;
+	m_nKeyframeTime = 0;
+	m_nKeyframeRetryTime = 0;
+
+	m_nRecordedBytes = 0;
+	m_nDroppedBytes = 0;
+	m_nDroppedChunks = 0;
+	m_nUnreportedDrops = 0;
+	m_nUnreportedChunks = 0;
+	m_nDroppedKeyframes = 0;
+
+	pthread_mutex_init(&m_lock, NULL);
+	pthread_cond_init(&m_writerCond, NULL);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+	stop();
+
+	free(m_pending.data);
+	free(m_writing.data);
+	free(m_text.data);
+
+	pthread_mutex_destroy(&m_lock);
+	pthread_cond_destroy(&m_writerCond);
+}
+
+/**
+ * Starts recording into a new file, which is replaced if it exists.
+ * Returns 0 if success.
+ */
+int SessionRecorder::start(const char *sFileName, SRFormat_t format, int nWidth, int nHeight)
+{
+	if (m_bRecording || sFileName == NULL)
+	{
+		return -1;
+	}
+
+	m_fd = open(sFileName, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+	if (m_fd < 0)
+	{
+		Logger::getInstance()->error("Cannot open recording: '%s'", sFileName);
+		return -1;
+	}
+
+	//Keep the recording out of child processes.
+	fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+
+	m_format = format;
+	m_bStopping = false;
+	m_bWriteError = false;
+	m_nFileOffset = 0;
+	m_keyframes.clear();
+	m_nKeyframeBytes = 0;
+	m_nKeyframeTime = 0;
+	m_nKeyframeRetryTime = 0;
+	gettimeofday(&m_startTime, NULL);
+
+	writeHeader(nWidth, nHeight);
+
+	m_bRecording = true;
+
+	if (pthread_create(&m_writerThread, NULL, writerThread, this) != 0)
+	{
+		Logger::getInstance()->error("Cannot start recording thread.");
+		m_bRecording = false;
+		close(m_fd);
+		m_fd = -1;
+		return -1;
+	}
+
+	Logger::getInstance()->info("Recording session to '%s'.", sFileName);
+
+	return 0;
+}
+
+/**
+ * Stops recording. Whatever is pending is written out before this returns.
+ */
+void SessionRecorder::stop()
+{
+	pthread_mutex_lock(&m_lock);
+
+	if (!m_bRecording)
+	{
+		pthread_mutex_unlock(&m_lock);
+		return;
+	}
+
+	appendDropMarker(getTime());
+
+	m_bRecording = false;
+	m_bStopping = true;
+	pthread_cond_signal(&m_writerCond);
+
+	pthread_mutex_unlock(&m_lock);
+
+	pthread_join(m_writerThread, NULL);
+
+	if (m_format == SR_FORMAT_BINARY)
+	{
+		writeIndex();
+	}
+
+	close(m_fd);
+	m_fd = -1;
+
+	Logger::getInstance()->info("Recorded %d bytes, dropped %d bytes in %d chunks, including %d keyframes.",
+		(int)m_nRecordedBytes, (int)m_nDroppedBytes, m_nDroppedChunks, m_nDroppedKeyframes);
+}
+
+/**
+ * Records output of the terminal. Never waits for the disk.
+ */
+void SessionRecorder::recordOutput(const char *data, size_t size)
+{
+	if (size > 0)
+	{
+		addRecord(SR_RECORD_OUTPUT, data, size);
+		m_nKeyframeBytes += size;
+	}
+}
+
+void SessionRecorder::recordResize(int nWidth, int nHeight)
+{
+	char size[32];
+
+	snprintf(size, sizeof(size), "%dx%d", nWidth, nHeight);
+	addRecord(SR_RECORD_RESIZE, size, strlen(size));
+}
+
+/**
+ * Checks whether enough output was recorded since the last keyframe to write another.
+ * Must be called from the same thread as recordOutput().
+ */
+bool SessionRecorder::isKeyframeDue()
+{
+	uint64_t nTime = getTime();
+
+	return (m_bRecording && m_format == SR_FORMAT_BINARY && m_nKeyframeBytes >= KEYFRAME_BYTES
+		&& (nTime - m_nKeyframeTime) >= KEYFRAME_INTERVAL_USEC && (nTime - m_nKeyframeRetryTime) >= KEYFRAME_INTERVAL_USEC);
+}
+
+/**
+ * Records a snapshot of the state, which must hold all the output recorded so far and
+ * nothing more. Only the binary log has keyframes. A keyframe holds the display and the
+ * most recent history lines only, so taking one does not hold up parsing for longer as the
+ * scrollback grows; seeking restores as much history as the keyframe holds.
+ */
+void SessionRecorder::recordKeyframe(TerminalState *state)
+{
+	char *data = NULL;
+	size_t size = 0;
+	FILE *file;
+
+	if (m_format != SR_FORMAT_BINARY || !m_bRecording)
+	{
+		return;
+	}
+
+	m_nKeyframeRetryTime = getTime();
+
+	file = open_memstream(&data, &size);
+
+	if (file == NULL)
+	{
+		return;
+	}
+
+	TerminalSnapshot snapshot(file);
+	snapshot.setMaxHistoryLines(KEYFRAME_HISTORY_LINES);
+
+	int nResult = snapshot.save(state);
+
+	if (fclose(file) != 0 || nResult != 0)
+	{
+		free(data);
+		return;
+	}
+
+	//A keyframe that was dropped is tried again after the interval.
+	if (addRecord(SR_RECORD_KEYFRAME, data, size) == 0)
+	{
+		m_nKeyframeBytes = 0;
+		m_nKeyframeTime = m_nKeyframeRetryTime;
+	}
+	else if (m_bRecording)
+	{
+		m_nDroppedKeyframes++;
+		Logger::getInstance()->warn("Keyframe of %d bytes did not fit in the recording buffer.", (int)size);
+	}
+
+	free(data);
+}
+
+size_t SessionRecorder::getRecordedBytes()
+{
+	return m_nRecordedBytes;
+}
+
+size_t SessionRecorder::getDroppedBytes()
+{
+	return m_nDroppedBytes;
+}
+
+int SessionRecorder::getDroppedChunks()
+{
+	return m_nDroppedChunks;
+}
+
+int SessionRecorder::getDroppedKeyframes()
+{
+	return m_nDroppedKeyframes;
+}
+
+/**
+ * Gets the time since the recording started, in microseconds.
+ */
+uint64_t SessionRecorder::getTime()
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+
+	return ((uint64_t)(now.tv_sec - m_startTime.tv_sec) * 1000000) + now.tv_usec - m_startTime.tv_usec;
+}
+
+/**
+ * Adds a record to the pending buffer, joining output that follows the previous output
+ * closely. If the buffer is full, the record is dropped and the drop is noted with a marker
+ * once there is room again. Resizes are small and replays depend on them, so they are
+ * never dropped for lack of room.
+ * Returns 0 if the record was added, -1 if it was dropped.
+ */
+int SessionRecorder::addRecord(SRRecord_t type, const char *data, size_t size)
+{
+	uint64_t nTime = getTime();
+	size_t nMarkerSize = (m_nUnreportedChunks > 0) ? (RECORD_HEADER_SIZE + 64) : 0;
+	int nResult = 0;
+
+	pthread_mutex_lock(&m_lock);
+
+	if (!m_bRecording)
+	{
+		pthread_mutex_unlock(&m_lock);
+		return -1;
+	}
+
+	if (type == SR_RECORD_OUTPUT && m_bCoalesce && (nTime - m_nLastTime) < COALESCE_USEC
+		&& (m_pending.size + size) <= MAX_PENDING_SIZE && appendBuffer(&m_pending, data, size) == 0)
+	{
+		unsigned char *length = (unsigned char *)m_pending.data + m_nLastRecord + 9;
+
+		putInt(length, getInt(length) + size);
+		m_nRecordedBytes += size;
+	}
+	else if (type != SR_RECORD_RESIZE && (m_pending.size + nMarkerSize + RECORD_HEADER_SIZE + size) > MAX_PENDING_SIZE)
+	{
+		dropRecord(size);
+		nResult = -1;
+	}
+	else
+	{
+		appendDropMarker(nTime);
+
+		m_nLastRecord = m_pending.size;
+		m_nLastTime = nTime;
+
+		if (appendRecord(type, nTime, data, size) == 0)
+		{
+			m_bCoalesce = (type == SR_RECORD_OUTPUT);
+
+			if (type == SR_RECORD_OUTPUT)
+			{
+				m_nRecordedBytes += size;
+			}
+		}
+		else
+		{
+			dropRecord(size);
+			nResult = -1;
+		}
+	}
+
+	if (m_pending.size >= FLUSH_SIZE)
+	{
+		pthread_cond_signal(&m_writerCond);
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return nResult;
+}
+
+/**
+ * Counts a record that was dropped, to be noted by the next marker.
+ * Must be called with the lock held.
+ */
+void SessionRecorder::dropRecord(size_t size)
+{
+	m_nDroppedBytes += size;
+	m_nDroppedChunks++;
+	m_nUnreportedDrops += size;
+	m_nUnreportedChunks++;
+	m_bCoalesce = false;
+}
+
+/**
+ * Appends a marker for the records dropped since the last marker, if any.
+ * Must be called with the lock held.
+ */
+void SessionRecorder::appendDropMarker(uint64_t nTime)
+{
+	char marker[64];
+
+	if (m_nUnreportedChunks == 0)
+	{
+		return;
+	}
+
+	snprintf(marker, sizeof(marker), "dropped %lu bytes in %d records", (unsigned long)m_nUnreportedDrops, m_nUnreportedChunks);
+
+	if (appendRecord(SR_RECORD_MARKER, nTime, marker, strlen(marker)) == 0)
+	{
+		m_nUnreportedDrops = 0;
+		m_nUnreportedChunks = 0;
+	}
+}
+
+/**
+ * Appends a record to the pending buffer. Must be called with the lock held.
+ * A record that cannot be appended whole is left out, so the records after it stay framed.
+ * Returns 0 if success.
+ */
+int SessionRecorder::appendRecord(SRRecord_t type, uint64_t nTime, const char *data, size_t size)
+{
+	unsigned char header[RECORD_HEADER_SIZE];
+	size_t nPendingSize = m_pending.size;
+
+	header[0] = type;
+	putInt64(header + 1, nTime);
+	putInt(header + 9, size);
+
+	if (appendBuffer(&m_pending, header, sizeof(header)) != 0 || appendBuffer(&m_pending, data, size) != 0)
+	{
+		m_pending.size = nPendingSize;
+		m_bCoalesce = false;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Appends data to a buffer, doubling its capacity as needed.
+ * Returns 0 if success.
+ */
+int SessionRecorder::appendBuffer(SRBuffer_t *buffer, const void *data, size_t size)
+{
+	if ((buffer->size + size) > buffer->capacity)
+	{
+		size_t capacity = (buffer->capacity > 0) ? buffer->capacity : 4096;
+
+		while (capacity < (buffer->size + size))
+		{
+			capacity *= 2;
+		}
+
+		char *newData = (char *)realloc(buffer->data, capacity);
+
+		if (newData == NULL)
+		{
+			return -1;
+		}
+
+		buffer->data = newData;
+		buffer->capacity = capacity;
+	}
+
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+
+	return 0;
+}
+
+/**
+ * Writes to the recording, retrying short writes.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int SessionRecorder::writeAll(const char *data, size_t size)
+{
+	while (size > 0)
+	{
+		ssize_t result = write(m_fd, data, size);
+
+		if (result < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (!m_bWriteError)
+			{
+				Logger::getInstance()->error("Cannot write recording.");
+				m_bWriteError = true;
+			}
+
+			return -1;
+		}
+
+		data += result;
+		size -= result;
+		m_nFileOffset += result;
+	}
+
+	return 0;
+}
+
+void SessionRecorder::writeHeader(int nWidth, int nHeight)
+{
+	if (m_format == SR_FORMAT_ASCIICAST)
+	{
+		char header[128];
+
+		snprintf(header, sizeof(header), "{\"version\": 2, \"width\": %d, \"height\": %d, \"timestamp\": %ld}\n",
+			nWidth, nHeight, (long)m_startTime.tv_sec);
+		writeAll(header, strlen(header));
+	}
+	else if (m_format == SR_FORMAT_BINARY)
+	{
+		unsigned char header[FILE_HEADER_SIZE];
+
+		putInt(header, MAGIC);
+		putInt(header + 4, VERSION);
+		putInt(header + 8, nWidth);
+		putInt(header + 12, nHeight);
+		putInt(header + 16, m_startTime.tv_sec);
+		putInt(header + 20, m_startTime.tv_usec);
+		writeAll((const char *)header, sizeof(header));
+	}
+}
+
+/**
+ * Writes the records swapped out of the pending buffer in one go. The binary log takes
+ * them as they are, noting where the keyframes go; asciicast gets one line per record and
+ * raw gets the output alone.
+ */
+void SessionRecorder::writeRecords()
+{
+	size_t nOffset = 0;
+
+	m_text.size = 0;
+
+	while ((nOffset + RECORD_HEADER_SIZE) <= m_writing.size)
+	{
+		const unsigned char *header = (const unsigned char *)m_writing.data + nOffset;
+		uint64_t nTime = getInt(header + 1) | ((uint64_t)getInt(header + 5) << 32);
+		size_t nSize = getInt(header + 9);
+
+		if (m_format == SR_FORMAT_BINARY)
+		{
+			if (header[0] == SR_RECORD_KEYFRAME)
+			{
+				SRKeyframe_t keyframe;
+
+				keyframe.nTime = nTime;
+				keyframe.nOffset = m_nFileOffset + nOffset;
+				m_keyframes.push_back(keyframe);
+			}
+		}
+		else if (m_format == SR_FORMAT_ASCIICAST)
+		{
+			appendEvent(nTime, header[0], (const char *)header + RECORD_HEADER_SIZE, nSize);
+		}
+		else if (header[0] == SR_RECORD_OUTPUT)
+		{
+			appendBuffer(&m_text, header + RECORD_HEADER_SIZE, nSize);
+		}
+
+		nOffset += RECORD_HEADER_SIZE + nSize;
+	}
+
+	if (m_format == SR_FORMAT_BINARY)
+	{
+		writeAll(m_writing.data, m_writing.size);
+	}
+	else
+	{
+		writeAll(m_text.data, m_text.size);
+	}
+}
+
+/**
+ * Writes the index of the keyframes and the trailer that points to it.
+ */
+void SessionRecorder::writeIndex()
+{
+	SRBuffer_t index;
+	unsigned char buffer[16]; //Fits a record header, an index entry or the trailer.
+	uint64_t nIndexOffset = m_nFileOffset;
+
+	memset(&index, 0, sizeof(index));
+
+	buffer[0] = SR_RECORD_INDEX;
+	putInt64(buffer + 1, getTime());
+	putInt(buffer + 9, m_keyframes.size() * 16);
+	appendBuffer(&index, buffer, RECORD_HEADER_SIZE);
+
+	for (size_t i = 0; i < m_keyframes.size(); i++)
+	{
+		putInt64(buffer, m_keyframes[i].nTime);
+		putInt64(buffer + 8, m_keyframes[i].nOffset);
+		appendBuffer(&index, buffer, 16);
+	}
+
+	putInt64(buffer, nIndexOffset);
+	putInt(buffer + 8, INDEX_MAGIC);
+	appendBuffer(&index, buffer, TRAILER_SIZE);
+
+	if (index.data != NULL)
+	{
+		writeAll(index.data, index.size);
+	}
+
+	free(index.data);
+}
+
+/**
+ * Appends an asciicast v2 event line: [time, type, data].
+ */
+void SessionRecorder::appendEvent(uint64_t nTime, char type, const char *data, size_t size)
+{
+	char prefix[64];
+
+	snprintf(prefix, sizeof(prefix), "[%lu.%06lu, \"%c\", \"",
+		(unsigned long)(nTime / 1000000), (unsigned long)(nTime % 1000000), type);
+
+	appendBuffer(&m_text, prefix, strlen(prefix));
+	appendJSONString(data, size, (type == SR_RECORD_OUTPUT));
+	appendBuffer(&m_text, "\"]\n", 3);
+}
+
+/**
+ * Appends data as the contents of a JSON string. Control characters are escaped and
+ * invalid UTF-8 is replaced. An incomplete UTF-8 sequence at the end of output is held
+ * back and finished with the next output, since reads split characters anywhere.
+ */
+void SessionRecorder::appendJSONString(const char *data, size_t size, bool bHoldTail)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	char escape[8];
+	size_t i = 0;
+
+	if (bHoldTail && m_nUTF8TailSize > 0)
+	{
+		size_t nLength = getUTF8Length(m_utf8Tail[0]);
+
+		while (m_nUTF8TailSize < nLength && i < size && isUTF8Continuation(bytes[i]))
+		{
+			m_utf8Tail[m_nUTF8TailSize++] = bytes[i++];
+		}
+
+		if (m_nUTF8TailSize < nLength && i == size)
+		{
+			return;
+		}
+
+		if (m_nUTF8TailSize == nLength)
+		{
+			appendBuffer(&m_text, m_utf8Tail, nLength);
+		}
+		else
+		{
+			appendBuffer(&m_text, "\\ufffd", 6);
+		}
+
+		m_nUTF8TailSize = 0;
+	}
+
+	while (i < size)
+	{
+		unsigned char c = bytes[i];
+
+		if (c == '"' || c == '\\')
+		{
+			escape[0] = '\\';
+			escape[1] = c;
+			appendBuffer(&m_text, escape, 2);
+			i++;
+		}
+		else if (c < 0x20 || c == 0x7F)
+		{
+			switch (c)
+			{
+			case '\n':
+				appendBuffer(&m_text, "\\n", 2);
+				break;
+			case '\r':
+				appendBuffer(&m_text, "\\r", 2);
+				break;
+			case '\t':
+				appendBuffer(&m_text, "\\t", 2);
+				break;
+			default:
+				snprintf(escape, sizeof(escape), "\\u%04x", c);
+				appendBuffer(&m_text, escape, 6);
+				break;
+			}
+
+			i++;
+		}
+		else if (c < 0x80)
+		{
+			size_t nStart = i;
+
+			while (i < size && bytes[i] >= 0x20 && bytes[i] < 0x7F && bytes[i] != '"' && bytes[i] != '\\')
+			{
+				i++;
+			}
+
+			appendBuffer(&m_text, data + nStart, i - nStart);
+		}
+		else
+		{
+			size_t nLength = getUTF8Length(c);
+			size_t nValid = (nLength > 0) ? 1 : 0;
+
+			while (nValid > 0 && nValid < nLength && (i + nValid) < size && isUTF8Continuation(bytes[i + nValid]))
+			{
+				nValid++;
+			}
+
+			if (nLength > 0 && nValid == nLength)
+			{
+				appendBuffer(&m_text, data + i, nLength);
+				i += nLength;
+			}
+			else if (nLength > 0 && (i + nValid) == size && bHoldTail)
+			{
+				memcpy(m_utf8Tail, data + i, nValid);
+				m_nUTF8TailSize = nValid;
+				i += nValid;
+			}
+			else
+			{
+				appendBuffer(&m_text, "\\ufffd", 6);
+				i++;
+			}
+		}
+	}
+}
+
+/**
+ * Writes out the pending records whenever enough have built up or some time has passed,
+ * so the disk sees a few large writes instead of one per read.
+ */
+int SessionRecorder::runWriter()
+{
+	struct timeval now;
+	struct timespec timeout;
+
+	pthread_mutex_lock(&m_lock);
+
+	while (true)
+	{
+		if (!m_bStopping && m_pending.size < FLUSH_SIZE)
+		{
+			gettimeofday(&now, NULL);
+			timeout.tv_sec = now.tv_sec;
+			timeout.tv_nsec = (now.tv_usec * 1000) + FLUSH_INTERVAL_NSEC;
+
+			if (timeout.tv_nsec >= 1000000000L)
+			{
+				timeout.tv_sec++;
+				timeout.tv_nsec -= 1000000000L;
+			}
+
+			pthread_cond_timedwait(&m_writerCond, &m_lock, &timeout);
+		}
+
+		if (m_pending.size == 0)
+		{
+			if (m_bStopping)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		SRBuffer_t swap = m_pending;
+		m_pending = m_writing;
+		m_writing = swap;
+		m_pending.size = 0;
+		m_bCoalesce = false;
+
+		pthread_mutex_unlock(&m_lock);
+
+		writeRecords();
+		m_writing.size = 0;
+
+		pthread_mutex_lock(&m_lock);
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return 0;
+}
+
+void *SessionRecorder::writerThread(void *recorder)
+{
+	((SessionRecorder *)recorder)->runWriter();
+	pthread_exit(NULL);
+	return NULL;
+}
@@ -0,0 +1,176 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONRECORDER_HPP__
+#define SESSIONRECORDER_HPP__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include <vector>
+
+#include "terminalstate.hpp"
+
+typedef enum
+{
+	SR_FORMAT_BINARY = 0,
+	SR_FORMAT_ASCIICAST,
+	SR_FORMAT_RAW //Output bytes only, without timing.
+} SRFormat_t;
+
+/**
+ * Kinds of records. The values are the event codes of asciicast v2.
+ */
+typedef enum
+{
+	SR_RECORD_OUTPUT = 'o',
+	SR_RECORD_RESIZE = 'r',
+	SR_RECORD_MARKER = 'm',
+	SR_RECORD_KEYFRAME = 'k', //Binary log only.
+	SR_RECORD_INDEX = 'x' //Binary log only.
+} SRRecord_t;
+
+/**
+ * Where a keyframe record starts in a binary log.
+ */
+typedef struct
+{
+	uint64_t nTime;
+	uint64_t nOffset;
+} SRKeyframe_t;
+
+/**
+ * A growable byte buffer.
+ */
+typedef struct
+{
+	char *data;
+	size_t size;
+	size_t capacity;
+} SRBuffer_t;
+
+/**
+ * Records the output of a terminal with timestamps, as asciicast v2 or as a binary log,
+ * or just the output bytes.
+ *
+ * The binary log starts with the magic "XWRC", the version, the screen width and height,
+ * and the start time in seconds and microseconds. Each record follows as a one byte
+ * SRRecord_t, the time since the start in microseconds as 64 bits, the data length as
+ * 32 bits, and the data. Resize records hold "<width>x<height>". Numbers are little endian.
+ *
+ * Keyframe records hold a TerminalSnapshot of the state after all output before them,
+ * so playback can start from the nearest keyframe instead of the beginning. When the
+ * recording stops, an index record listing the time and offset of every keyframe is
+ * added, followed by a trailer of the index record offset as 64 bits and the magic
+ * "XWRI". A log without the trailer, cut off by a crash, is still readable.
+ *
+ * Recording never blocks the reader on disk. Records are appended to a pending buffer,
+ * which a writer thread swaps out and writes in one go. Output that comes in shortly after
+ * the previous output joins its record. When the writer falls behind and the pending buffer
+ * is full, records other than resizes are dropped and counted, and a marker record notes
+ * the gap.
+ */
+class SessionRecorder
+{
+private:
+	static const size_t MAX_PENDING_SIZE;
+	static const size_t FLUSH_SIZE;
+	static const long FLUSH_INTERVAL_NSEC;
+	static const uint64_t COALESCE_USEC;
+	static const size_t KEYFRAME_BYTES;
+	static const uint64_t KEYFRAME_INTERVAL_USEC;
+	static const int KEYFRAME_HISTORY_LINES;
+
+	int m_fd;
+	SRFormat_t m_format;
+	struct timeval m_startTime;
+	bool m_bRecording;
+	bool m_bStopping;
+	bool m_bWriteError;
+
+	SRBuffer_t m_pending; //Records waiting for the writer thread.
+	SRBuffer_t m_writing; //Records being written.
+	SRBuffer_t m_text; //Records of m_writing, as asciicast.
+	size_t m_nLastRecord; //Offset of the last output record in m_pending, open to coalescing.
+	bool m_bCoalesce;
+	uint64_t m_nLastTime;
+	char m_utf8Tail[4]; //Incomplete UTF-8 sequence held back for the next asciicast event.
+	size_t m_nUTF8TailSize;
+
+	uint64_t m_nFileOffset; //Bytes written so far.
+	std::vector<SRKeyframe_t> m_keyframes; //Keyframes written so far.
+	size_t m_nKeyframeBytes; //Output recorded since the last keyframe.
+	uint64_t m_nKeyframeTime; //Time of the last keyframe.
+	uint64_t m_nKeyframeRetryTime; //Time of the last attempt to record a keyframe.
+
+	size_t m_nRecordedBytes;
+	size_t m_nDroppedBytes;
+	int m_nDroppedChunks;
+	size_t m_nUnreportedDrops;
+	int m_nUnreportedChunks;
+	int m_nDroppedKeyframes;
+
+	pthread_t m_writerThread;
+	pthread_mutex_t m_lock; //Mutex lock for the pending buffer and counters.
+	pthread_cond_t m_writerCond; //Signalled when the writer should flush.
+
+	uint64_t getTime();
+	int addRecord(SRRecord_t type, const char *data, size_t size);
+	void dropRecord(size_t size);
+	void appendDropMarker(uint64_t nTime);
+	int appendRecord(SRRecord_t type, uint64_t nTime, const char *data, size_t size);
+
+	static int appendBuffer(SRBuffer_t *buffer, const void *data, size_t size);
+	int writeAll(const char *data, size_t size);
+	void writeHeader(int nWidth, int nHeight);
+	void writeRecords();
+	void writeIndex();
+	void appendEvent(uint64_t nTime, char type, const char *data, size_t size);
+	void appendJSONString(const char *data, size_t size, bool bHoldTail);
+
+	int runWriter();
+	static void *writerThread(void *recorder);
+
+public:
+	static const unsigned int MAGIC;
+	static const int VERSION;
+	static const size_t FILE_HEADER_SIZE;
+	static const size_t RECORD_HEADER_SIZE;
+	static const unsigned int INDEX_MAGIC;
+	static const size_t TRAILER_SIZE;
+
+	SessionRecorder();
+	~SessionRecorder();
+
+	int start(const char *sFileName, SRFormat_t format, int nWidth, int nHeight);
+	void stop();
+
+	void recordOutput(const char *data, size_t size);
+	void recordResize(int nWidth, int nHeight);
+	bool isKeyframeDue();
+	void recordKeyframe(TerminalState *state);
+
+	size_t getRecordedBytes();
+	size_t getDroppedBytes();
+	int getDroppedChunks();
+	int getDroppedKeyframes();
+};
+
+#endif
@@ -0,0 +1,966 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sessionserver.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "terminal.hpp"
+#include "terminalsnapshot.hpp"
+#include "util/logger.hpp"
+
+const size_t SessionServer::HEADER_SIZE = 5;
+const size_t SessionServer::MAX_MESSAGE_SIZE = (16 * 1024 * 1024);
+const size_t SessionServer::MIN_QUEUE_SIZE = (64 * 1024);
+const size_t SessionServer::MAX_QUEUE_SIZE = (4 * 1024 * 1024);
+const int SessionServer::POLL_MSEC = 250;
+const int SessionServer::MAX_SCREEN_SIZE = 65535;
+
+SessionServer::SessionServer()
+{
+	m_manager = NULL;
+	m_sPath = NULL;
+	m_listenFD = -1;
+	m_wakePipe[0] = -1;
+	m_wakePipe[1] = -1;
+	m_bDone = false;
+	m_bStarted = false;
+	m_bSessionExited = false;
+
+	pthread_mutex_init(&m_lock, NULL);
+}
+
+SessionServer::~SessionServer()
+{
+	stop();
+
+	pthread_mutex_destroy(&m_lock);
+}
+
+/**
+ * Gets the socket used when none is given: xwterm.sock in the runtime directory of the
+ * user, or in a directory in /tmp named after the user ID, which is created only
+ * accessible to the user if missing.
+ */
+const char *SessionServer::getDefaultPath()
+{
+	static char sPath[108];
+	const char *sRuntimeDir = getenv("XDG_RUNTIME_DIR");
+
+	if (sRuntimeDir != NULL && sRuntimeDir[0] != '\0' && strlen(sRuntimeDir) + 12 < sizeof(sPath))
+	{
+		snprintf(sPath, sizeof(sPath), "%s/xwterm.sock", sRuntimeDir);
+	}
+	else
+	{
+		snprintf(sPath, sizeof(sPath), "/tmp/xwterm-%d", (int)getuid());
+
+		if (mkdir(sPath, 0700) != 0 && errno != EEXIST)
+		{
+			Logger::getInstance()->warn("Cannot create directory '%s'.", sPath);
+		}
+
+		strcat(sPath, "/xwterm.sock");
+	}
+
+	return sPath;
+}
+
+/**
+ * Checks that the process on the other end of the socket runs as the same user.
+ * Anyone else could read and type into the sessions, or show a fake one.
+ */
+bool SessionServer::isSameUser(int nFD)
+{
+	struct ucred cred;
+	socklen_t nSize = sizeof(cred);
+
+	if (getsockopt(nFD, SOL_SOCKET, SO_PEERCRED, &cred, &nSize) != 0 || nSize != sizeof(cred))
+	{
+		return false;
+	}
+
+	return cred.uid == getuid();
+}
+
+void SessionServer::putInt(unsigned char *buffer, uint32_t nValue)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		buffer[i] = (nValue >> (i * 8)) & 0xFF;
+	}
+}
+
+uint32_t SessionServer::getInt(const unsigned char *buffer)
+{
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+/**
+ * Starts the sessions and listens on the socket. New sessions run the NULL terminated
+ * command, which must stay valid while the server runs, or log in if there is none.
+ * The given number of sessions are kept started ahead of time, ready for new clients.
+ * Fails if another server is listening on the socket already.
+ * Returns 0 if success.
+ */
+int SessionServer::start(const char *sPath, const char *const *command, int nPoolSize)
+{
+	struct sockaddr_un address;
+	mode_t mask;
+
+	if (sPath == NULL || strlen(sPath) >= sizeof(address.sun_path))
+	{
+		Logger::getInstance()->error("Invalid session server socket.");
+		return -1;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, sPath);
+
+	m_listenFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (m_listenFD < 0)
+	{
+		Logger::getInstance()->error("Cannot create session server socket.");
+		return -1;
+	}
+
+	if (connect(m_listenFD, (struct sockaddr *)&address, sizeof(address)) == 0)
+	{
+		if (!isSameUser(m_listenFD))
+		{
+			Logger::getInstance()->error("Session server socket '%s' belongs to another user.", sPath);
+			stop();
+			return -1;
+		}
+
+		Logger::getInstance()->error("A session server is running on '%s' already.", sPath);
+		stop();
+		return -1;
+	}
+
+	//Nobody is listening, so the socket was left behind by a server that died.
+	unlink(sPath);
+	close(m_listenFD);
+
+	m_listenFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+	//Only the user may connect.
+	mask = umask(077);
+
+	if (m_listenFD < 0 || bind(m_listenFD, (struct sockaddr *)&address, sizeof(address)) != 0)
+	{
+		umask(mask);
+		Logger::getInstance()->error("Cannot bind session server socket '%s'.", sPath);
+		stop();
+		return -1;
+	}
+
+	umask(mask);
+	m_sPath = strdup(sPath);
+
+	if (listen(m_listenFD, 16) != 0 || pipe2(m_wakePipe, O_CLOEXEC | O_NONBLOCK) != 0)
+	{
+		Logger::getInstance()->error("Cannot listen on session server socket.");
+		stop();
+		return -1;
+	}
+
+	m_manager = new SessionManager();
+	m_manager->setCommand(command);
+	m_manager->setPoolSize(nPoolSize);
+
+	if (m_manager->start() != 0)
+	{
+		Logger::getInstance()->error("Cannot start sessions of the server.");
+		stop();
+		return -1;
+	}
+
+	if (pthread_create(&m_thread, NULL, serverThread, this) != 0)
+	{
+		Logger::getInstance()->error("Cannot start session server thread.");
+		stop();
+		return -1;
+	}
+
+	m_bStarted = true;
+
+	Logger::getInstance()->info("Session server listening on '%s'.", sPath);
+
+	return 0;
+}
+
+/**
+ * Disconnects the clients, ends the sessions and removes the socket.
+ */
+void SessionServer::stop()
+{
+	if (m_bStarted)
+	{
+		pthread_mutex_lock(&m_lock);
+		m_bDone = true;
+		pthread_mutex_unlock(&m_lock);
+
+		wake();
+		pthread_join(m_thread, NULL);
+
+		m_bStarted = false;
+	}
+
+	while (!m_clients.empty())
+	{
+		closeClient(m_clients.back());
+	}
+
+	if (m_manager != NULL)
+	{
+		delete m_manager;
+		m_manager = NULL;
+	}
+
+	if (m_listenFD >= 0)
+	{
+		close(m_listenFD);
+		m_listenFD = -1;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (m_wakePipe[i] >= 0)
+		{
+			close(m_wakePipe[i]);
+			m_wakePipe[i] = -1;
+		}
+	}
+
+	if (m_sPath != NULL)
+	{
+		unlink(m_sPath);
+		free(m_sPath);
+		m_sPath = NULL;
+	}
+}
+
+SessionManager *SessionServer::getManager()
+{
+	return m_manager;
+}
+
+void *SessionServer::serverThread(void *server)
+{
+	((SessionServer *)server)->runServer();
+
+	return NULL;
+}
+
+/**
+ * Interrupts the server thread if it is waiting in poll.
+ */
+void SessionServer::wake()
+{
+	char c = 0;
+
+	if (m_wakePipe[1] >= 0)
+	{
+		write(m_wakePipe[1], &c, 1);
+	}
+}
+
+/**
+ * Waits on the socket, the wake pipe and every client, and handles whatever is ready.
+ * Only this thread adds or removes clients, or changes the session they are attached to.
+ */
+int SessionServer::runServer()
+{
+	std::vector<struct pollfd> fds;
+	struct timeval lastCheck;
+	struct timeval now;
+	char drain[64];
+	bool bExited;
+
+	gettimeofday(&lastCheck, NULL);
+
+	while (true)
+	{
+		struct pollfd fd;
+
+		fds.clear();
+
+		pthread_mutex_lock(&m_lock);
+
+		if (m_bDone)
+		{
+			pthread_mutex_unlock(&m_lock);
+			break;
+		}
+
+		fd.fd = m_listenFD;
+		fd.events = POLLIN;
+		fds.push_back(fd);
+
+		fd.fd = m_wakePipe[0];
+		fds.push_back(fd);
+
+		for (size_t i = 0; i < m_clients.size(); i++)
+		{
+			fd.fd = m_clients[i]->nFD;
+			fd.events = POLLIN | ((m_clients[i]->queue->size() > 0) ? POLLOUT : 0);
+			fds.push_back(fd);
+		}
+
+		pthread_mutex_unlock(&m_lock);
+
+		if (poll(&fds[0], fds.size(), POLL_MSEC) < 0 && errno != EINTR)
+		{
+			Logger::getInstance()->error("Cannot wait on session server clients.");
+			return -1;
+		}
+
+		if (fds[1].revents & POLLIN)
+		{
+			while (read(m_wakePipe[0], drain, sizeof(drain)) > 0);
+		}
+
+		//Clients accepted below are not in the poll set yet.
+		size_t nNumClients = fds.size() - 2;
+
+		if (fds[0].revents & POLLIN)
+		{
+			acceptClient();
+		}
+
+		for (size_t i = 0; i < nNumClients; i++)
+		{
+			SSClient_t *client = m_clients[i];
+			short revents = fds[i + 2].revents;
+
+			if ((revents & (POLLIN | POLLHUP | POLLERR)) && readClient(client) != 0)
+			{
+				client->bClosed = true;
+			}
+
+			if (!client->bClosed && (revents & POLLOUT) && writeClient(client) != 0)
+			{
+				client->bClosed = true;
+			}
+		}
+
+		for (size_t i = 0; i < m_clients.size(); i++)
+		{
+			SSClient_t *client = m_clients[i];
+
+			if (client->bClosed)
+			{
+				closeClient(client);
+				i--;
+			}
+			else if (client->bResync && client->session != NULL && client->queue->size() == 0)
+			{
+				Session *session = client->session;
+
+				session->getState()->lock();
+				pthread_mutex_lock(&m_lock);
+				sendSnapshot(client);
+				pthread_mutex_unlock(&m_lock);
+				session->getState()->unlock();
+			}
+			else if (client->bDirty && !client->bWaitAck && client->session != NULL)
+			{
+				sendDelta(client);
+			}
+		}
+
+		gettimeofday(&now, NULL);
+
+		pthread_mutex_lock(&m_lock);
+		bExited = m_bSessionExited;
+		m_bSessionExited = false;
+		pthread_mutex_unlock(&m_lock);
+
+		//Sessions are told when their child exits, except on kernels without pidfd.
+		if (bExited || (now.tv_sec - lastCheck.tv_sec) * 1000 + (now.tv_usec - lastCheck.tv_usec) / 1000 >= POLL_MSEC)
+		{
+			closeExitedSessions();
+			lastCheck = now;
+		}
+	}
+
+	return 0;
+}
+
+void SessionServer::acceptClient()
+{
+	int nFD = accept4(m_listenFD, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+	if (nFD < 0)
+	{
+		return;
+	}
+
+	if (!isSameUser(nFD))
+	{
+		Logger::getInstance()->warn("Session server client of another user refused.");
+		close(nFD);
+		return;
+	}
+
+	SSClient_t *client = new SSClient_t;
+
+	client->nFD = nFD;
+	client->session = NULL;
+	client->readData = NULL;
+	client->nReadSize = 0;
+	client->nReadCapacity = 0;
+	client->queue = new RingBuffer(MIN_QUEUE_SIZE);
+	client->bResync = false;
+	client->encoder = NULL;
+	client->bDirty = false;
+	client->bWaitAck = false;
+	client->bClosed = false;
+
+	pthread_mutex_lock(&m_lock);
+	m_clients.push_back(client);
+	pthread_mutex_unlock(&m_lock);
+
+	Logger::getInstance()->debug("Session server client connected.");
+}
+
+/**
+ * Reads what the client sent and handles every complete message.
+ * Returns -1 if the client is gone or sent something invalid. Returns 0 if success.
+ */
+int SessionServer::readClient(SSClient_t *client)
+{
+	while (true)
+	{
+		if (client->nReadCapacity - client->nReadSize < 4096)
+		{
+			size_t nCapacity = (client->nReadCapacity == 0) ? 16384 : (client->nReadCapacity * 2);
+			char *data = (char *)realloc(client->readData, nCapacity);
+
+			if (data == NULL)
+			{
+				return -1;
+			}
+
+			client->readData = data;
+			client->nReadCapacity = nCapacity;
+		}
+
+		ssize_t nResult = read(client->nFD, client->readData + client->nReadSize, client->nReadCapacity - client->nReadSize);
+
+		if (nResult == 0)
+		{
+			return -1;
+		}
+		else if (nResult < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+		}
+
+		client->nReadSize += nResult;
+
+		size_t nOffset = 0;
+
+		while (client->nReadSize - nOffset >= HEADER_SIZE)
+		{
+			const unsigned char *header = (const unsigned char *)client->readData + nOffset;
+			size_t size = getInt(header + 1);
+
+			if (size > MAX_MESSAGE_SIZE)
+			{
+				Logger::getInstance()->warn("Session server client sent a message that is too large.");
+				return -1;
+			}
+
+			if (client->nReadSize - nOffset < HEADER_SIZE + size)
+			{
+				break;
+			}
+
+			handleMessage(client, header[0], client->readData + nOffset + HEADER_SIZE, size);
+			nOffset += HEADER_SIZE + size;
+		}
+
+		if (nOffset > 0)
+		{
+			memmove(client->readData, client->readData + nOffset, client->nReadSize - nOffset);
+			client->nReadSize -= nOffset;
+		}
+	}
+}
+
+/**
+ * Sends as much of the queue as the socket takes.
+ * Returns -1 if the client is gone. Returns 0 if success.
+ */
+int SessionServer::writeClient(SSClient_t *client)
+{
+	struct iovec vectors[2];
+	struct msghdr message;
+	int nResult = 0;
+
+	pthread_mutex_lock(&m_lock);
+
+	while (client->queue->size() > 0)
+	{
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = vectors;
+		message.msg_iovlen = client->queue->getReadVectors(vectors);
+
+		ssize_t nSent = sendmsg(client->nFD, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		if (nSent < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				nResult = -1;
+			}
+
+			break;
+		}
+
+		client->queue->consume(nSent);
+	}
+
+	if (client->queue->size() == 0 && client->queue->capacity() > MIN_QUEUE_SIZE)
+	{
+		//Release the memory of a snapshot or a burst of output.
+		client->queue->resize(MIN_QUEUE_SIZE);
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return nResult;
+}
+
+void SessionServer::closeClient(SSClient_t *client)
+{
+	pthread_mutex_lock(&m_lock);
+	m_clients.erase(std::find(m_clients.begin(), m_clients.end(), client));
+	pthread_mutex_unlock(&m_lock);
+
+	close(client->nFD);
+	free(client->readData);
+	delete client->queue;
+	delete client->encoder;
+	delete client;
+
+	Logger::getInstance()->debug("Session server client disconnected.");
+}
+
+void SessionServer::handleMessage(SSClient_t *client, int nType, const char *data, size_t size)
+{
+	const unsigned char *values = (const unsigned char *)data;
+
+	switch (nType)
+	{
+	case SS_MSG_ATTACH:
+		if (size >= 12)
+		{
+			attach(client, (int32_t)getInt(values), getScreenSize(values + 4), getScreenSize(values + 8), (size >= 16) ? getInt(values + 12) : SS_ATTACH_NONE);
+		}
+		break;
+	case SS_MSG_INPUT:
+		if (client->session != NULL)
+		{
+			client->session->getTerminal()->insertData(data, size);
+		}
+		break;
+	case SS_MSG_PASTE:
+		if (client->session != NULL && size >= 1)
+		{
+			client->session->getTerminal()->pasteData(data + 1, size - 1, data[0] != 0);
+		}
+		break;
+	case SS_MSG_RESIZE:
+		if (size >= 8)
+		{
+			resize(client, getScreenSize(values), getScreenSize(values + 4));
+		}
+		break;
+	case SS_MSG_ACK:
+		pthread_mutex_lock(&m_lock);
+		client->bWaitAck = false;
+		pthread_mutex_unlock(&m_lock);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Reads a width or height sent by a client, limited to what a screen delta can carry.
+ */
+int SessionServer::getScreenSize(const unsigned char *buffer)
+{
+	uint32_t nSize = getInt(buffer);
+
+	if (nSize < 1)
+	{
+		return 1;
+	}
+
+	return (nSize > (uint32_t)MAX_SCREEN_SIZE) ? MAX_SCREEN_SIZE : (int)nSize;
+}
+
+/**
+ * Attaches the client to the session at the given index, or to a new session if the index
+ * is negative, and sends it a snapshot. The session takes the size of the client.
+ * A client attached for deltas gets the whole screen as its first delta.
+ */
+void SessionServer::attach(SSClient_t *client, int nIndex, int nWidth, int nHeight, int nFlags)
+{
+	Session *session;
+
+	if (nIndex < 0)
+	{
+		session = m_manager->createSession(nWidth, nHeight);
+
+		if (session != NULL)
+		{
+			session->setListener(this);
+		}
+	}
+	else
+	{
+		session = m_manager->getSession(nIndex);
+	}
+
+	if (session == NULL)
+	{
+		pthread_mutex_lock(&m_lock);
+		queueMessage(client, SS_MSG_ERROR, NULL, 0, false);
+		pthread_mutex_unlock(&m_lock);
+		return;
+	}
+
+	//The client gets no output of the session before the snapshot.
+	session->getState()->lock();
+
+	pthread_mutex_lock(&m_lock);
+	client->session = session;
+	client->bResync = true;
+
+	if ((nFlags & SS_ATTACH_DELTA) && client->encoder == NULL)
+	{
+		client->encoder = new ScreenDeltaEncoder();
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	//Tells the other clients of the session about the new size.
+	resize(client, nWidth, nHeight);
+
+	pthread_mutex_lock(&m_lock);
+	sendSnapshot(client);
+	pthread_mutex_unlock(&m_lock);
+
+	session->getState()->unlock();
+}
+
+/**
+ * Resizes the session of the client and tells every client of the session.
+ */
+void SessionServer::resize(SSClient_t *client, int nWidth, int nHeight)
+{
+	Session *session = client->session;
+	unsigned char data[8];
+
+	if (session == NULL)
+	{
+		return;
+	}
+
+	session->getState()->lock();
+
+	session->resize(nWidth, nHeight);
+
+	Point size = session->getState()->getDisplayScreenSize();
+
+	putInt(data, size.getX());
+	putInt(data + 4, size.getY());
+
+	pthread_mutex_lock(&m_lock);
+
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		if (m_clients[i]->session != session || m_clients[i]->bResync)
+		{
+			continue;
+		}
+
+		if (m_clients[i]->encoder != NULL)
+		{
+			//The next delta carries the size.
+			m_clients[i]->bDirty = true;
+		}
+		else
+		{
+			queueMessage(m_clients[i], SS_MSG_RESIZE, (const char *)data, sizeof(data), false);
+		}
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	session->getState()->unlock();
+}
+
+/**
+ * Queues a snapshot of the session of the client, which it parses the output after.
+ * Must be called with the lock of the state and the lock of the clients held.
+ */
+void SessionServer::sendSnapshot(SSClient_t *client)
+{
+	char *data = NULL;
+	size_t size = 0;
+	FILE *file;
+	int nIndex = 0;
+
+	client->bResync = false;
+
+	while (m_manager->getSession(nIndex) != client->session && m_manager->getSession(nIndex) != NULL)
+	{
+		nIndex++;
+	}
+
+	file = open_memstream(&data, &size);
+
+	if (file == NULL)
+	{
+		client->bClosed = true;
+		return;
+	}
+
+	fwrite("\0\0\0\0", 1, 4, file);
+
+	TerminalSnapshot snapshot(file);
+	int nResult = snapshot.save(client->session->getState());
+
+	if (fclose(file) == 0 && nResult == 0)
+	{
+		size_t nPendingSize;
+		const char *pending = client->session->getState()->getPendingSequence(nPendingSize);
+
+		putInt((unsigned char *)data, nIndex);
+		queueMessage(client, SS_MSG_SNAPSHOT, data, size, false);
+
+		if (client->encoder != NULL)
+		{
+			//Deltas start over from the whole screen.
+			client->encoder->reset();
+			client->bDirty = true;
+		}
+		else if (nPendingSize > 0)
+		{
+			//A snapshot has no parser state, so the start of a sequence cut off is sent again.
+			queueMessage(client, SS_MSG_OUTPUT, pending, nPendingSize, false);
+		}
+	}
+	else
+	{
+		Logger::getInstance()->error("Cannot take snapshot for session server client.");
+		client->bClosed = true;
+	}
+
+	free(data);
+}
+
+/**
+ * Queues a delta from the screen last sent to the client to the current screen of its
+ * session, if the screen changed.
+ */
+void SessionServer::sendDelta(SSClient_t *client)
+{
+	Session *session = client->session;
+	std::vector<char> delta;
+
+	session->getState()->lock();
+	pthread_mutex_lock(&m_lock);
+
+	client->bDirty = false;
+
+	if (client->encoder->encode(session->getState(), delta) != 0)
+	{
+		client->bClosed = true;
+	}
+	else if (!delta.empty() && queueMessage(client, SS_MSG_DELTA, &delta[0], delta.size(), false))
+	{
+		client->bWaitAck = true;
+	}
+
+	pthread_mutex_unlock(&m_lock);
+	session->getState()->unlock();
+}
+
+/**
+ * Ends the sessions whose child exited, and tells their clients how it exited.
+ */
+void SessionServer::closeExitedSessions()
+{
+	unsigned char status[4];
+
+	for (int i = 0; i < m_manager->getNumSessions(); i++)
+	{
+		Session *session = m_manager->getSession(i);
+
+		if (session == NULL || !session->getTerminal()->isDone())
+		{
+			continue;
+		}
+
+		putInt(status, session->getTerminal()->getExitStatus());
+
+		for (size_t j = 0; j < m_clients.size(); j++)
+		{
+			//The last screen goes out whether or not the previous delta was applied.
+			if (m_clients[j]->session == session && m_clients[j]->encoder != NULL)
+			{
+				sendDelta(m_clients[j]);
+			}
+		}
+
+		pthread_mutex_lock(&m_lock);
+
+		for (size_t j = 0; j < m_clients.size(); j++)
+		{
+			if (m_clients[j]->session == session)
+			{
+				queueMessage(m_clients[j], SS_MSG_EXIT, (const char *)status, sizeof(status), false);
+				m_clients[j]->session = NULL;
+				m_clients[j]->bResync = false;
+			}
+		}
+
+		pthread_mutex_unlock(&m_lock);
+
+		m_manager->closeSession(session);
+		i--;
+	}
+}
+
+/**
+ * Queues a message for the client. Limited messages are not queued if the queue is full.
+ * Must be called with the lock of the clients held.
+ * Returns true if the message was queued.
+ */
+bool SessionServer::queueMessage(SSClient_t *client, int nType, const char *data, size_t size, bool bLimit)
+{
+	unsigned char header[HEADER_SIZE];
+	size_t nQueued = client->queue->size();
+	size_t nNeeded = nQueued + HEADER_SIZE + size;
+
+	if (client->bClosed || (bLimit && nNeeded > MAX_QUEUE_SIZE))
+	{
+		return false;
+	}
+
+	if (nNeeded > client->queue->capacity() && client->queue->resize(nNeeded) != 0)
+	{
+		client->bClosed = true;
+		return false;
+	}
+
+	header[0] = nType;
+	putInt(header + 1, size);
+
+	client->queue->write((const char *)header, HEADER_SIZE);
+
+	if (size > 0)
+	{
+		client->queue->write(data, size);
+	}
+
+	if (nQueued == 0)
+	{
+		wake();
+	}
+
+	return true;
+}
+
+/**
+ * Passes the output of a session on to its clients. A client that cannot keep up gets
+ * a new snapshot once it catches up, instead of the output it missed.
+ */
+void SessionServer::sessionOutput(Session *session, const char *data, size_t size)
+{
+	pthread_mutex_lock(&m_lock);
+
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		SSClient_t *client = m_clients[i];
+
+		if (client->session != session || client->bResync)
+		{
+			continue;
+		}
+
+		if (client->encoder != NULL)
+		{
+			//The screen is encoded once the client is ready for it, so a burst costs one delta.
+			if (!client->bDirty && !client->bWaitAck)
+			{
+				wake();
+			}
+
+			client->bDirty = true;
+		}
+		else if (!queueMessage(client, SS_MSG_OUTPUT, data, size, true))
+		{
+			client->bResync = true;
+		}
+	}
+
+	pthread_mutex_unlock(&m_lock);
+}
+
+void SessionServer::sessionUpdated(Session *session)
+{
+}
+
+/**
+ * Has the server thread end the session right away. Called from the parser thread.
+ */
+void SessionServer::sessionExited(Session *session, int nStatus)
+{
+	pthread_mutex_lock(&m_lock);
+	m_bSessionExited = true;
+	pthread_mutex_unlock(&m_lock);
+
+	wake();
+}
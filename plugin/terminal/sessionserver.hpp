@@ -0,0 +1,142 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONSERVER_HPP__
+#define SESSIONSERVER_HPP__
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "screendelta.hpp"
+#include "session.hpp"
+#include "sessionmanager.hpp"
+#include "util/ringbuffer.hpp"
+
+/**
+ * Messages between the session server and its clients. Every message starts with a
+ * header of the type in one byte and the size of the rest in four bytes, little endian.
+ */
+typedef enum
+{
+	SS_MSG_ATTACH = 1, //Client: session index (-1 for a new one), width, height, then optionally attach flags.
+	SS_MSG_INPUT, //Client: bytes typed into the session.
+	SS_MSG_PASTE, //Client: bracketed flag in one byte, then the pasted bytes.
+	SS_MSG_RESIZE, //Both: width, height.
+	SS_MSG_SNAPSHOT, //Server: session index, then a snapshot of the terminal state.
+	SS_MSG_OUTPUT, //Server: output of the session, to parse after the snapshot.
+	SS_MSG_EXIT, //Server: the child of the session exited, with its status as returned by waitpid.
+	SS_MSG_ERROR, //Server: the attach failed.
+	SS_MSG_DELTA, //Server: screen delta, sent instead of the output to clients attached for deltas.
+	SS_MSG_ACK //Client: the last screen delta was applied.
+} SSMessage_t;
+
+typedef enum
+{
+	SS_ATTACH_NONE = 0,
+	SS_ATTACH_DELTA = 1 //Get screen deltas instead of the output. Only the latest screen is sent.
+} SSAttachFlag_t;
+
+/**
+ * A connection to the server, attached to at most one session.
+ */
+typedef struct
+{
+	int nFD;
+	Session *session; //Attached session, or NULL.
+	char *readData; //Partial message read so far.
+	size_t nReadSize;
+	size_t nReadCapacity;
+	RingBuffer *queue; //Messages waiting to be sent.
+	bool bResync; //Output was dropped. A new snapshot is sent once the queue drains.
+	ScreenDeltaEncoder *encoder; //Set if the client gets screen deltas instead of the output.
+	bool bDirty; //The screen changed since the last delta.
+	bool bWaitAck; //A delta was sent that the client has not applied yet.
+	bool bClosed;
+} SSClient_t;
+
+/**
+ * Owns the sessions and serves them to front ends over a local Unix socket, so that closing
+ * a front end does not end its session.
+ * A client attaches to a session and gets a snapshot of the terminal state, then the output
+ * of the session to parse itself. The snapshot and the output are both taken under the lock
+ * of the state, so they line up. The state is kept up to date while nobody is attached, so
+ * attaching only costs one snapshot, however much output there was in the meantime.
+ * A client that falls too far behind gets a new snapshot instead of the output it missed.
+ * A client may ask for screen deltas instead of the output. It then gets a delta only once it
+ * applied the previous one, so during heavy output it skips the screens in between.
+ */
+class SessionServer : public SessionListener
+{
+private:
+	static const size_t MIN_QUEUE_SIZE;
+	static const size_t MAX_QUEUE_SIZE;
+	static const int POLL_MSEC;
+	static const int MAX_SCREEN_SIZE;
+
+	SessionManager *m_manager;
+	char *m_sPath;
+	int m_listenFD;
+	int m_wakePipe[2];
+	std::vector<SSClient_t *> m_clients;
+	bool m_bDone;
+	bool m_bStarted;
+	bool m_bSessionExited; //A session ended since its sessions were last checked.
+	pthread_t m_thread;
+	pthread_mutex_t m_lock; //Mutex lock for the clients. Taken after the lock of a state.
+
+	int runServer();
+	static void *serverThread(void *server);
+	void wake();
+
+	void acceptClient();
+	int readClient(SSClient_t *client);
+	int writeClient(SSClient_t *client);
+	void closeClient(SSClient_t *client);
+	static int getScreenSize(const unsigned char *buffer);
+	void handleMessage(SSClient_t *client, int nType, const char *data, size_t size);
+	void attach(SSClient_t *client, int nIndex, int nWidth, int nHeight, int nFlags);
+	void resize(SSClient_t *client, int nWidth, int nHeight);
+	void sendSnapshot(SSClient_t *client);
+	void sendDelta(SSClient_t *client);
+	void closeExitedSessions();
+	bool queueMessage(SSClient_t *client, int nType, const char *data, size_t size, bool bLimit);
+
+public:
+	static const size_t HEADER_SIZE;
+	static const size_t MAX_MESSAGE_SIZE;
+
+	SessionServer();
+	virtual ~SessionServer();
+
+	static const char *getDefaultPath();
+	static bool isSameUser(int nFD);
+	static void putInt(unsigned char *buffer, uint32_t nValue);
+	static uint32_t getInt(const unsigned char *buffer);
+
+	int start(const char *sPath, const char *const *command, int nPoolSize = 0);
+	void stop();
+	SessionManager *getManager();
+
+	void sessionOutput(Session *session, const char *data, size_t size);
+	void sessionUpdated(Session *session);
+	void sessionExited(Session *session, int nStatus);
+};
+
+#endif
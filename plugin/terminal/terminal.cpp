@@ -1,677 +1,1626 @@
-/**
- * This file is part of SDLTerminal.
- * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
- *
- * SDLTerminal is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * SDLTerminal is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
-
- * You should have received a copy of the GNU General Public License
- * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include <errno.h>
-#include <fcntl.h>
-#include <signal.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stropts.h>
-#include <termios.h>
-#include <unistd.h>
-
-#include "util/logger.hpp"
-#include "terminal.hpp"
-
-struct termios terminal_global_state;
-int terminal_global_slave_fd = -1;
-
-void terminal_restore_settings()
-{
-	if (terminal_global_slave_fd >= 0)
-	{
-		if (tcsetattr(terminal_global_slave_fd, TCSAFLUSH, &terminal_global_state) < 0)
-		{
-			Logger::getInstance()->error("Cannot restore initial terminal settings.");
-		}
-	}
-}
-
-void terminal_save_settings(int slaveFD)
-{
-	terminal_global_slave_fd = slaveFD;
-
-	if (terminal_global_slave_fd >= 0)
-	{
-		if (tcgetattr(terminal_global_slave_fd, &terminal_global_state) < 0)
-		{
-			terminal_global_slave_fd = -1;
-			Logger::getInstance()->error("Cannot save initial terminal settings.");
-		}
-	}
-}
-
-Terminal::Terminal()
-{
-	m_masterFD = -1;
-	m_slaveFD = -1;
-	m_bDone = false;
-	m_dataBuffer = new DataBuffer();
-	m_nWritePriority = 0;
-	m_sUser = NULL;
-
-	setUser("root");
-	memset(&m_winSize, 0, sizeof(m_winSize));
-
-	pthread_mutexattr_init(&m_masterLockAttr);
-	pthread_mutexattr_settype(&m_masterLockAttr, PTHREAD_MUTEX_RECURSIVE);
-	pthread_mutex_init(&m_masterLock, &m_masterLockAttr);
-}
-
-Terminal::~Terminal()
-{
-	if (isReady())
-	{
-		m_bDone = true;
-		pthread_join(m_readerThread, NULL);
-	}
-
-	terminal_restore_settings();
-	terminal_global_slave_fd = -1;
-
-	if (m_masterFD >= 0)
-	{
-		close(m_masterFD);
-	}
-
-	if (m_slaveFD >= 0)
-	{
-		close(m_slaveFD);
-	}
-
-	free(m_sUser);
-	delete m_dataBuffer;
-
-	pthread_mutexattr_destroy(&m_masterLockAttr);
-	pthread_mutex_destroy(&m_masterLock);
-}
-
-int Terminal::openPTYMaster()
-{
-	Logger::getInstance()->info("Initializing master.");
-
-	m_masterFD = posix_openpt(O_RDWR | O_NOCTTY);
-
-	if (m_masterFD < 0)
-	{
-		Logger::getInstance()->error("Cannot get master pseudo-terminal.");
-		return -1;
-	}
-
-	if (grantpt(m_masterFD) < 0 || unlockpt(m_masterFD) < 0)
-	{
-		Logger::getInstance()->error("Cannot grant access permission for master pseudo-terminal.");
-		return -2;
-	}
-
-	m_slaveName = ptsname(m_masterFD);
-
-	if (m_slaveName == NULL)
-	{
-		Logger::getInstance()->error("Cannot get name of slave pseudo-terminal.");
-		return -3;
-	}
-
-	Logger::getInstance()->info("Initialized master with FD %d.", m_masterFD);
-
-	return 0;
-}
-
-int Terminal::openPTYSlave()
-{
-	Logger::getInstance()->info("Initializing slave with name '%s'.", m_slaveName);
-
-	m_slaveFD = open(m_slaveName, O_RDWR);
-
-	if (m_slaveFD == -1)
-	{
-		Logger::getInstance()->error("Cannot open slave pseudo-terminal.");
-		return -1;
-	}
-
-	if (ioctl(m_slaveFD, I_FIND, "ptem") == 0)
-	{
-		if (ioctl(m_slaveFD, I_PUSH, "ptem") < 0 || ioctl(m_slaveFD, I_PUSH, "ldterm") < 0 || ioctl(m_slaveFD, I_PUSH, "ttcompat") < 0)
-		{
-			Logger::getInstance()->error("Cannot push modules for slave pseudo-terminal.");
-			return -2;
-		}
-	}
-
-	Logger::getInstance()->info("Initialized slave with name '%s' with FD %d.", m_slaveName, m_slaveFD);
-
-	return 0;
-}
-
-int Terminal::forkPTY()
-{
-	if (openPTYMaster() != 0)
-	{
-		Logger::getInstance()->error("Cannot open master PTY.");
-		return -1;
-	}
-
-	if (openPTYSlave() != 0)
-	{
-		Logger::getInstance()->error("Cannot open slave PTY.");
-		return -2;
-	}
-
-	//Save terminal settings to be restored at exit.
-	terminal_save_settings(m_slaveFD);
-
-	m_pid = fork();
-
-	if (m_pid < 0)
-	{
-		Logger::getInstance()->error("Cannot fork process.");
-		return -3;
-	}
-
-	if (m_pid == 0)
-	{
-		Logger::getInstance()->info("Initializing child terminal process.");
-
-		//Child process.
-		if (setsid() < 0)
-		{
-			Logger::getInstance()->error("Cannot set child session.");
-			return -4;
-		}
-
-		for (int i = 0, max = sysconf(_SC_OPEN_MAX); i < max ; i++)
-		{
-			if(i != m_slaveFD)
-			{
-				close(i);
-				
-				if (i == m_masterFD)
-				{
-					m_masterFD = -1;
-				}
-			}
-		}
-
-		//Acquire controlling of terminal.
-		if (openPTYSlave() != 0)
-		{
-			Logger::getInstance()->error("Cannot acquire slave as controlling terminal.");
-			return -5;
-		}
-
-#ifdef TIOCSCTTY //For BSD compatibility.
-		if (ioctl(m_slaveFD, TIOCSCTTY, NULL) < 0)
-		{
-			Logger::getInstance()->error("Cannot set slave as controlling terminal in BSD.");
-			return -6;
-		}
-#endif
-
-		if (dup2(m_slaveFD, STDIN_FILENO) != STDIN_FILENO)
-		{
-			Logger::getInstance()->error("Cannot duplicate slave into stdin.");
-			return -7;
-		}
-
-		if (dup2(m_slaveFD, STDOUT_FILENO) != STDOUT_FILENO)
-		{
-			Logger::getInstance()->error("Cannot duplicate slave into stdout.");
-			return -8;
-		}
-
-		if (dup2(m_slaveFD, STDERR_FILENO) != STDERR_FILENO)
-		{
-			Logger::getInstance()->error("Cannot duplicate slave into stderr.");
-			return -9;
-		}
-
-		Logger::getInstance()->info("Initialized child terminal process.");
-	}
-	else
-	{
-		Logger::getInstance()->info("Created child terminal process with PID %d.", m_pid);
-	}
-
-	if (atexit(terminal_restore_settings) != 0)
-	{
-		Logger::getInstance()->info("Cannot set terminal restore state function at exit.");
-		return -10;
-	}
-
-	return 0;
-}
-
-int Terminal::setFlag(int fileDesc, int flags)
-{
-	int val = fcntl(fileDesc, F_GETFL, 0);
-
-	if (val < 0)
-	{
-		Logger::getInstance()->error("Cannot get flags from file descriptor.");
-		return -1;
-	}
-
-	val |= flags;
-
-	if (fcntl(fileDesc, F_SETFL, val) < 0)
-	{
-		Logger::getInstance()->error("Cannot set flags on file descriptor.");
-		return -1;
-	}
-
-	return 0;
-}
-
-int Terminal::sendCommand(const char *command)
-{
-	int cmdCharIndex = 0;
-	char dataBuffer[4];
-	struct timeval timeout;
-	fd_set writeFDSet;
-	bool bDone = false;
-
-	Logger::getInstance()->dump("Sending command '%s' to FD %d.", command, m_masterFD);
-	++m_nWritePriority;
-
-	//Write input command.
-	while(!bDone)
-	{
-		pthread_mutex_lock(&m_masterLock);
-
-		FD_ZERO(&writeFDSet);
-		FD_SET(m_masterFD, &writeFDSet);
-
-		timeout.tv_sec = 0;
-		timeout.tv_usec = 1;
-
-		if (select(m_masterFD + 1, NULL, &writeFDSet, NULL, &timeout) < 1)
-		{
-			//Pseudo terminal is not ready to write.
-		}
-		else if (FD_ISSET(m_masterFD, &writeFDSet))
-		{
-			if (command[cmdCharIndex] != 0)
-			{
-				dataBuffer[0] = command[cmdCharIndex];
-
-				if (write(m_masterFD, dataBuffer, 1) > 0)
-				{
-					++cmdCharIndex;
-				}
-				else
-				{
-					Logger::getInstance()->warn("Cannot write to master.");
-				}
-			}
-
-			if (command[cmdCharIndex] == 0)
-			{
-				//Nothing more to write.
-				Logger::getInstance()->dump("Sent pseudo terminal command '%s'.", command);
-				bDone = true;
-			}
-		}
-
-		pthread_mutex_unlock(&m_masterLock);
-	}
-
-	--m_nWritePriority;
-
-	return 0;
-}
-
-bool Terminal::isChild()
-{
-	return (m_pid == 0);
-}
-
-int Terminal::start()
-{
-	Logger::getInstance()->info("Starting pseudo terminal.");
-
-	int result = forkPTY();
-
-	if (result == 0)
-	{
-		if (isChild())
-		{
-			const char *argv[5];
-
-			argv[0] = "/bin/login";
-			argv[1] = "-p";
-			argv[2] = "-f";
-			argv[3] = getUser();
-			argv[4] = NULL;
-
-			setWindowSize();
-			setTermMode();
-
-			if (execvp(((char **)argv)[0], ((char **)argv)) < 0)
-			{
-				Logger::getInstance()->error("Cannot execute child shell.");
-			}
-
-			_exit(0);
-		}
-
-		sleep(1);
-
-		if (startReaderThread() == 0)
-		{
-			Logger::getInstance()->info("Started pseudo terminal.");
-			setReady(true);
-		}
-		else
-		{
-			Logger::getInstance()->error("Cannot create reader thread.");
-			result = -1;
-		}
-	}
-
-	return result;
-}
-
-int Terminal::runReader()
-{
-	char dataBuffer[256];
-	size_t dataBufferSize = sizeof(dataBuffer);
-	ssize_t readResult;
-	struct timeval timeout;
-	fd_set readFDSet;
-	int result = 0;
-
-	m_bDone = false;
-
-	while(!m_bDone)
-	{
-		pthread_mutex_lock(&m_masterLock);
-
-		FD_ZERO(&readFDSet);
-		FD_SET (m_masterFD, &readFDSet);
-
-		timeout.tv_sec = 0;
-		timeout.tv_usec = 1;
-
-		while(!m_bDone)
-		{
-			if (m_nWritePriority > 0)
-			{
-				break;
-			}
-			else if (select(m_masterFD + 1, &readFDSet, NULL, NULL, &timeout) < 1)
-			{
-				//Pseudo terminal is not ready to read.
-				break;
-			}
-			else if (FD_ISSET(m_masterFD, &readFDSet))
-			{
-				// Read one character at a time.
-				readResult = read(m_masterFD, dataBuffer, dataBufferSize);
-
-				if (readResult < 0)
-				{
-					Logger::getInstance()->error("Cannot read pseudo terminal.");
-					result = -1;
-					m_bDone = true;
-				}
-				else if (readResult == 0)
-				{
-					//EOF
-					m_bDone = true;
-				}
-				else
-				{
-					m_dataBuffer->append(dataBuffer, readResult);
-
-					if (readResult < dataBufferSize)
-					{
-						flushOutputBuffer();
-					}
-				}
-			}
-			else
-			{
-				//Pseudo terminal is not ready to read.
-				break;
-			}
-		}
-
-		flushOutputBuffer();
-
-		pthread_mutex_unlock(&m_masterLock);
-		pthread_yield();
-	}
-
-	return result;
-}
-
-void Terminal::flushOutputBuffer()
-{
-	pthread_mutex_lock(&m_masterLock);
-
-	char *tmp;
-	int nTmpSize;
-
-	//Transfer buffer to terminal state then flush buffer.
-	if (m_dataBuffer->size() > 0 && getExtTerminal() != NULL)
-	{
-		if (getExtTerminal()->isReady())
-		{
-			//Add a null terminating character.
-			nTmpSize = (m_dataBuffer->size() + 1) * sizeof(char);
-			tmp = (char *)malloc(nTmpSize);
-			memset(tmp, 0, nTmpSize);
-
-			m_dataBuffer->copy(tmp, m_dataBuffer->size());
-			m_dataBuffer->clear();
-
-			getExtTerminal()->insertData(tmp, nTmpSize);
-
-			free(tmp);
-		}
-	}
-
-	pthread_mutex_unlock(&m_masterLock);
-}
-
-int Terminal::startReaderThread()
-{
-	return pthread_create(&m_readerThread, NULL, readerThread, this);
-}
-
-void *Terminal::readerThread(void *terminal)
-{
-	((Terminal *)terminal)->runReader();
-	pthread_exit(NULL);
-	return NULL;
-}
-
-/**
- * Sets the window size when the TTY is initialized. Must be called before starting
- * the terminal to take effect.
- */
-void Terminal::setWindowSize(int nWidth, int nHeight)
-{
-	if (nWidth < 0)
-	{
-		nWidth = 0;
-	}
-
-	if (nHeight < 0)
-	{
-		nHeight = 0;
-	}
-
-	m_winSize.ws_col = nWidth;
-	m_winSize.ws_row = nHeight;
-}
-
-/**
- * Sets window size on the slave device. Should only be called on the child TTY process.
- */
-int Terminal::setWindowSize()
-{
-	if (m_winSize.ws_col == 0 && m_winSize.ws_row == 0)
-	{
-		//No change.
-		return 0;
-	}
-
-	if (m_winSize.ws_col <= 0 || m_winSize.ws_row <= 0)
-	{
-		Logger::getInstance()->warn("Invalid window size.");
-		return -1;
-	}
-
-	if (ioctl(m_slaveFD, TIOCSWINSZ, &m_winSize) < 0)
-	{
-		Logger::getInstance()->error("Cannot set window size.");
-		return -1;
-	}
-
-	return 0;
-}
-
-int Terminal::setCBreak()
-{
-	struct termios settings;
-
-	if (tcgetattr(m_slaveFD, &settings) < 0)
-	{
-		Logger::getInstance()->error("Cannot read terminal settings.");
-		return -1;
-	}
-
-	settings.c_lflag &= ~ICANON;
-	settings.c_cc[VMIN] = 1;
-	settings.c_cc[VTIME] = 0;
-
-	if (tcsetattr(m_slaveFD, TCSANOW, &settings) < 0)
-	{
-		Logger::getInstance()->error("Cannot write CBreak terminal settings.");
-		return -2;
-	}
-
-	return 0;
-}
-
-int Terminal::setTermMode()
-{
-	struct termios settings;
-
-	if (tcgetattr(m_slaveFD, &settings) < 0)
-	{
-		Logger::getInstance()->error("Cannot read terminal settings.");
-		return -1;
-	}
-
-	settings.c_lflag = (ISIG | ICANON | ECHO | ECHOE | ECHOK);
-
-#ifdef ECHOKE
-	settings.c_lflag |= (ECHOKE | IEXTEN);
-#endif
-
-#ifdef ECHOCTL
-	settings.c_lflag |= (ECHOCTL | IEXTEN);
-#endif
-
-	settings.c_iflag = (ICRNL | IXON);
-	settings.c_cflag = (CS8 | CREAD | PARENB | HUPCL);
-
-#ifdef TAB3
-	settings.c_oflag = (OPOST | ONLCR | TAB3);
-#else
-	#ifdef ONLCR
-		settings.c_oflag = (OPOST | ONLCR);
-	#else
-		settings.c_oflag = OPOST;
-	#endif
-#endif
-
-	settings.c_cc[VMIN] = 1;
-	settings.c_cc[VTIME] = 0;
-
-	if (tcsetattr(m_slaveFD, TCSANOW, &settings) < 0)
-	{
-		Logger::getInstance()->error("Cannot write default terminal settings.");
-		return -2;
-	}
-
-	return 0;
-}
-
-int Terminal::setRaw()
-{
-	struct termios settings;
-
-	if (tcgetattr(m_slaveFD, &settings) < 0)
-	{
-		Logger::getInstance()->error("Cannot read terminal settings.");
-		return -1;
-	}
-
-	settings.c_lflag &= ~(ICANON | IEXTEN | ISIG);
-	settings.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
-	settings.c_cflag &= ~(CSIZE | PARENB);
-	settings.c_cflag |= CS8;
-	settings.c_oflag &= ~(OPOST);
-	settings.c_cc[VMIN] = 1;
-	settings.c_cc[VTIME] = 0;
-
-	if (tcsetattr(m_slaveFD, TCSANOW, &settings) < 0)
-	{
-		Logger::getInstance()->error("Cannot write Raw terminal settings.");
-		return -2;
-	}
-
-	return 0;
-}
-
-void Terminal::insertData(const char *data, size_t size)
-{
-	if (size > 0)
-	{
-		/*
-		printf("Send command: ");
-		for (int i=0; i<strlen(data); i++)
-		{
-			printf("[%d]'%c'", data[i], data[i]);
-		}
-		printf("\n");
-		*/
-
-		sendCommand(data);
-	}
-}
-
-const char *Terminal::getUser()
-{
-	return m_sUser;
-}
-
-void Terminal::setUser(const char *sUser)
-{
-	if (sUser != NULL)
-	{
-		size_t userSize = (strlen(sUser) + 1) * sizeof(char);
-
-		m_sUser = (char *)realloc(m_sUser, userSize);
-		memcpy(m_sUser, sUser, userSize);
-	}
-}
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+//Newer C libraries dropped STREAMS, which Linux never had, along with its header.
+#ifdef __has_include
+#if __has_include(<stropts.h>)
+#include <stropts.h>
+#endif
+#else
+#include <stropts.h>
+#endif
+
+#ifndef CLOSE_RANGE_CLOEXEC
+#define CLOSE_RANGE_CLOEXEC (1U << 2)
+#endif
+
+#include <algorithm>
+
+#include "util/logger.hpp"
+#include "terminal.hpp"
+#include "ptybackend.hpp"
+#include "sessionmanager.hpp"
+
+const size_t Terminal::MIN_READ_BUFFER_SIZE = (16 * 1024);
+const size_t Terminal::MAX_READ_BUFFER_SIZE = (1024 * 1024);
+const size_t Terminal::READ_RESUME_DIVISOR = 4;
+const int Terminal::SHRINK_READ_BUFFER_BATCHES = 64;
+const size_t Terminal::MIN_WRITE_BUFFER_SIZE = (4 * 1024);
+const size_t Terminal::PASTE_CHUNK_SIZE = (4 * 1024);
+const size_t Terminal::MAX_PARSE_SIZE = (64 * 1024);
+const int Terminal::EXIT_WAIT_MSEC = 100;
+const int Terminal::EXIT_POLL_MSEC = 10;
+
+struct termios terminal_global_state;
+int terminal_global_slave_fd = -1;
+bool terminal_restore_registered = false;
+
+void terminal_restore_settings()
+{
+	if (terminal_global_slave_fd >= 0)
+	{
+		//Never waits for output of the child that nobody reads anymore.
+		if (tcsetattr(terminal_global_slave_fd, TCSANOW, &terminal_global_state) < 0)
+		{
+			Logger::getInstance()->error("Cannot restore initial terminal settings.");
+		}
+	}
+}
+
+void terminal_save_settings(int slaveFD)
+{
+	terminal_global_slave_fd = slaveFD;
+
+	if (terminal_global_slave_fd >= 0)
+	{
+		if (tcgetattr(terminal_global_slave_fd, &terminal_global_state) < 0)
+		{
+			terminal_global_slave_fd = -1;
+			Logger::getInstance()->error("Cannot save initial terminal settings.");
+		}
+	}
+}
+
+/**
+ * Gets a descriptor that becomes readable once the process exits, so that exiting can be
+ * waited for along with the masters. Needs Linux 5.3.
+ * Returns -1 if the kernel cannot do it.
+ */
+int terminal_open_pidfd(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+	return syscall(SYS_pidfd_open, pid, 0);
+#else
+	return -1;
+#endif
+}
+
+/**
+ * Marks every descriptor from the given one on to be closed on exec. Safe to call between
+ * vfork and exec.
+ */
+void terminal_close_from(int nFirstFD)
+{
+#ifdef SYS_close_range
+	//One call however many descriptors are open. Kernels before 5.11 can only close them.
+	if (syscall(SYS_close_range, nFirstFD, ~0U, CLOSE_RANGE_CLOEXEC) == 0
+		|| syscall(SYS_close_range, nFirstFD, ~0U, 0) == 0)
+	{
+		return;
+	}
+#endif
+
+	for (int i = nFirstFD, max = sysconf(_SC_OPEN_MAX); i < max; i++)
+	{
+		close(i);
+	}
+}
+
+/**
+ * Runs in the child between vfork and exec. The memory is still that of the parent, so
+ * only system calls are made. The reason exec failed is left in nError.
+ */
+void terminal_exec_child(const char *sSlaveName, char *const *argv, volatile int *nError)
+{
+	struct sigaction action;
+	sigset_t mask;
+	int nFD;
+
+	setsid();
+
+	//Opening the slave in the new session makes it the controlling terminal.
+	nFD = open(sSlaveName, O_RDWR);
+
+#ifdef TIOCSCTTY //For BSD compatibility.
+	if (nFD >= 0)
+	{
+		ioctl(nFD, TIOCSCTTY, 0);
+	}
+#endif
+
+	if (nFD < 0 || dup2(nFD, STDIN_FILENO) < 0 || dup2(nFD, STDOUT_FILENO) < 0 || dup2(nFD, STDERR_FILENO) < 0)
+	{
+		*nError = errno;
+		_exit(127);
+	}
+
+	if (nFD > STDERR_FILENO)
+	{
+		close(nFD);
+	}
+
+	terminal_close_from(STDERR_FILENO + 1);
+
+	//The handlers of the parent must not run here, and what it ignores is not for the child to ignore.
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = SIG_DFL;
+
+	for (int i = 1; i < NSIG; i++)
+	{
+		sigaction(i, &action, NULL);
+	}
+
+	sigemptyset(&mask);
+	sigprocmask(SIG_SETMASK, &mask, NULL);
+
+	execvp(argv[0], argv);
+
+	*nError = errno;
+	_exit(127);
+}
+
+Terminal::Terminal()
+{
+	m_masterFD = -1;
+	m_slaveFD = -1;
+	m_slaveName[0] = '\0';
+	m_manager = NULL;
+	m_bDone = false;
+	m_pid = -1;
+	m_pidFD = -1;
+	m_bExited = false;
+	m_nExitStatus = -1;
+	m_bExitReported = false;
+	m_readBuffer = new RingBuffer(MIN_READ_BUFFER_SIZE);
+	m_nSmallBatches = 0;
+	m_bParsing = false;
+	m_bReadPaused = false;
+	m_bXOffEnabled = false;
+	m_bXOffSent = false;
+	m_writeBuffer = new RingBuffer(MIN_WRITE_BUFFER_SIZE);
+	m_bWriteInFlight = false;
+	m_pasteData = NULL;
+	m_nPasteSize = 0;
+	m_nPasteSent = 0;
+	m_bPasteBracketed = false;
+	m_nMasterEvents = 0;
+	m_sUser = NULL;
+	m_command = NULL;
+
+	setUser("root");
+	memset(&m_winSize, 0, sizeof(m_winSize));
+
+	pthread_mutexattr_init(&m_writeLockAttr);
+	pthread_mutexattr_settype(&m_writeLockAttr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&m_writeLock, &m_writeLockAttr);
+	pthread_mutex_init(&m_pipelineLock, NULL);
+}
+
+Terminal::~Terminal()
+{
+	hangUp();
+	stopChild();
+
+	if (m_pidFD >= 0)
+	{
+		close(m_pidFD);
+	}
+
+	free(m_sUser);
+	setCommand(NULL);
+	delete m_readBuffer;
+	delete m_writeBuffer;
+	free(m_pasteData);
+
+	pthread_mutexattr_destroy(&m_writeLockAttr);
+	pthread_mutex_destroy(&m_writeLock);
+	pthread_mutex_destroy(&m_pipelineLock);
+}
+
+int Terminal::openPTYMaster()
+{
+	Logger::getInstance()->info("Initializing master.");
+
+	m_masterFD = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+	if (m_masterFD < 0)
+	{
+		Logger::getInstance()->error("Cannot get master pseudo-terminal.");
+		return -1;
+	}
+
+	if (grantpt(m_masterFD) < 0 || unlockpt(m_masterFD) < 0)
+	{
+		Logger::getInstance()->error("Cannot grant access permission for master pseudo-terminal.");
+		return -2;
+	}
+
+	//Not ptsname(), whose buffer is shared with terminals starting on other threads.
+	if (ptsname_r(m_masterFD, m_slaveName, sizeof(m_slaveName)) != 0)
+	{
+		Logger::getInstance()->error("Cannot get name of slave pseudo-terminal.");
+		return -3;
+	}
+
+	Logger::getInstance()->info("Initialized master with FD %d.", m_masterFD);
+
+	return 0;
+}
+
+int Terminal::openPTYSlave()
+{
+	Logger::getInstance()->info("Initializing slave with name '%s'.", m_slaveName);
+
+	//Kept out of child processes. The child opens its own, as its controlling terminal.
+	m_slaveFD = open(m_slaveName, O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+	if (m_slaveFD == -1)
+	{
+		Logger::getInstance()->error("Cannot open slave pseudo-terminal.");
+		return -1;
+	}
+
+#ifdef I_PUSH
+	if (ioctl(m_slaveFD, I_FIND, "ptem") == 0)
+	{
+		if (ioctl(m_slaveFD, I_PUSH, "ptem") < 0 || ioctl(m_slaveFD, I_PUSH, "ldterm") < 0 || ioctl(m_slaveFD, I_PUSH, "ttcompat") < 0)
+		{
+			Logger::getInstance()->error("Cannot push modules for slave pseudo-terminal.");
+			return -2;
+		}
+	}
+#endif
+
+	Logger::getInstance()->info("Initialized slave with name '%s' with FD %d.", m_slaveName, m_slaveFD);
+
+	return 0;
+}
+
+/**
+ * Opens the pseudo terminal, sets it up and starts the child process on it. The child is
+ * created with vfork, so that starting it costs the same however much memory the parent uses.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int Terminal::spawnPTY()
+{
+	const char *argv[5];
+	char **command = m_command;
+	volatile int nError = 0;
+	sigset_t allSignals;
+	sigset_t savedSignals;
+
+	if (openPTYMaster() != 0)
+	{
+		Logger::getInstance()->error("Cannot open master PTY.");
+		return -1;
+	}
+
+	if (openPTYSlave() != 0)
+	{
+		Logger::getInstance()->error("Cannot open slave PTY.");
+		return -1;
+	}
+
+	//Never block on the master.
+	if (setFlag(m_masterFD, O_NONBLOCK) != 0)
+	{
+		return -1;
+	}
+
+	//Save terminal settings to be restored at exit.
+	terminal_save_settings(m_slaveFD);
+
+	//The child finds the slave ready, so output can be read as soon as it starts.
+	setWindowSize();
+	setTermMode();
+
+	if (command == NULL)
+	{
+		argv[0] = "/bin/login";
+		argv[1] = "-p";
+		argv[2] = "-f";
+		argv[3] = getUser();
+		argv[4] = NULL;
+
+		command = (char **)argv;
+	}
+
+	//No signal handler may run in the child while it shares the memory of the parent.
+	sigfillset(&allSignals);
+	pthread_sigmask(SIG_SETMASK, &allSignals, &savedSignals);
+
+	m_pid = vfork();
+
+	if (m_pid == 0)
+	{
+		terminal_exec_child(m_slaveName, command, &nError);
+	}
+
+	pthread_sigmask(SIG_SETMASK, &savedSignals, NULL);
+
+	if (m_pid < 0)
+	{
+		Logger::getInstance()->error("Cannot create child process.");
+		return -1;
+	}
+
+	//The parent resumes once the child called exec or gave up.
+	if (nError != 0)
+	{
+		Logger::getInstance()->error("Cannot execute '%s': %s.", command[0], strerror(nError));
+		waitChild(0);
+		return -1;
+	}
+
+	m_pidFD = terminal_open_pidfd(m_pid);
+
+	Logger::getInstance()->info("Created child terminal process with PID %d.", m_pid);
+
+	if (!terminal_restore_registered)
+	{
+		if (atexit(terminal_restore_settings) != 0)
+		{
+			Logger::getInstance()->info("Cannot set terminal restore state function at exit.");
+			return -1;
+		}
+
+		terminal_restore_registered = true;
+	}
+
+	return 0;
+}
+
+int Terminal::setFlag(int fileDesc, int flags)
+{
+	int val = fcntl(fileDesc, F_GETFL, 0);
+
+	if (val < 0)
+	{
+		Logger::getInstance()->error("Cannot get flags from file descriptor.");
+		return -1;
+	}
+
+	val |= flags;
+
+	if (fcntl(fileDesc, F_SETFL, val) < 0)
+	{
+		Logger::getInstance()->error("Cannot set flags on file descriptor.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Queues input for the child process. The data may contain null characters.
+ * Whatever the master accepts right away is written immediately; the rest is written
+ * by the session manager as the master becomes writable. Never blocks.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int Terminal::sendCommand(const char *command, size_t size)
+{
+	int result = 0;
+
+	if (m_masterFD < 0)
+	{
+		return -1;
+	}
+
+	Logger::getInstance()->dump("Sending %d bytes to FD %d.", (int)size, m_masterFD);
+
+	pthread_mutex_lock(&m_writeLock);
+
+	if (queueWrite(command, size) != 0)
+	{
+		result = -1;
+	}
+	else if (m_writeBuffer->size() == size)
+	{
+		//Nothing was waiting, so try to write it out straight away.
+		result = writeMaster();
+	}
+
+	pthread_mutex_unlock(&m_writeLock);
+
+	return result;
+}
+
+/**
+ * Appends data to the write queue, growing it as needed.
+ * Must be called with the write lock held.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int Terminal::queueWrite(const char *data, size_t size)
+{
+	size_t capacity = m_writeBuffer->capacity();
+
+	while ((capacity - m_writeBuffer->size()) < size)
+	{
+		capacity *= 2;
+	}
+
+	if (m_writeBuffer->resize(capacity) != 0)
+	{
+		Logger::getInstance()->error("Cannot queue input for pseudo terminal.");
+		return -1;
+	}
+
+	m_writeBuffer->write(data, size);
+
+	return 0;
+}
+
+/**
+ * Starts pasting data into the child process. The data is copied, then streamed into the
+ * write queue a chunk at a time as the master takes it, so a large paste neither blocks the
+ * caller nor holds up typed input for long. A paste already in progress is cancelled.
+ * Bracketed pastes have their escape characters removed.
+ */
+void Terminal::pasteData(const char *data, size_t size, bool bBracketed)
+{
+	if (m_masterFD < 0 || data == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&m_writeLock);
+
+	if (m_pasteData != NULL)
+	{
+		finishPaste();
+	}
+
+	m_pasteData = (char *)malloc(size + 1);
+
+	if (m_pasteData == NULL)
+	{
+		Logger::getInstance()->error("Cannot allocate paste of %d bytes.", (int)size);
+	}
+	else
+	{
+		if (bBracketed)
+		{
+			//Drop escape characters, so that the data cannot end the bracket early.
+			size_t nCopied = 0;
+
+			for (size_t i = 0; i < size; i++)
+			{
+				if (data[i] != '\x1B')
+				{
+					m_pasteData[nCopied++] = data[i];
+				}
+			}
+
+			size = nCopied;
+		}
+		else
+		{
+			memcpy(m_pasteData, data, size);
+		}
+
+		m_nPasteSize = size;
+		m_nPasteSent = 0;
+		m_bPasteBracketed = bBracketed;
+
+		if (m_bPasteBracketed)
+		{
+			queueWrite("\x1B[200~", 6);
+		}
+
+		writeMaster();
+	}
+
+	pthread_mutex_unlock(&m_writeLock);
+}
+
+/**
+ * Stops the paste in progress. Chunks already in the write queue are still sent.
+ */
+void Terminal::cancelPaste()
+{
+	pthread_mutex_lock(&m_writeLock);
+
+	if (m_pasteData != NULL)
+	{
+		Logger::getInstance()->info("Cancelled paste after %d of %d bytes.", (int)m_nPasteSent, (int)m_nPasteSize);
+		finishPaste();
+		writeMaster();
+	}
+
+	pthread_mutex_unlock(&m_writeLock);
+}
+
+/**
+ * Moves the next chunk of the paste into the write queue once the queue runs low.
+ * Must be called with the write lock held.
+ */
+void Terminal::feedPaste()
+{
+	size_t nChunkSize;
+
+	if (m_pasteData == NULL || m_writeBuffer->size() >= PASTE_CHUNK_SIZE)
+	{
+		return;
+	}
+
+	nChunkSize = m_nPasteSize - m_nPasteSent;
+
+	if (nChunkSize > PASTE_CHUNK_SIZE)
+	{
+		nChunkSize = PASTE_CHUNK_SIZE;
+	}
+
+	if (queueWrite(m_pasteData + m_nPasteSent, nChunkSize) == 0)
+	{
+		m_nPasteSent += nChunkSize;
+	}
+
+	if (m_nPasteSent >= m_nPasteSize)
+	{
+		finishPaste();
+	}
+	else if (getExtTerminal() != NULL)
+	{
+		getExtTerminal()->pasteProgress(m_nPasteSent, m_nPasteSize, false);
+	}
+}
+
+/**
+ * Ends the paste in progress, whether or not all of it was sent.
+ * Must be called with the write lock held.
+ */
+void Terminal::finishPaste()
+{
+	size_t nSent = m_nPasteSent;
+	size_t nSize = m_nPasteSize;
+
+	if (m_bPasteBracketed)
+	{
+		queueWrite("\x1B[201~", 6);
+	}
+
+	free(m_pasteData);
+	m_pasteData = NULL;
+	m_nPasteSize = 0;
+	m_nPasteSent = 0;
+	m_bPasteBracketed = false;
+
+	if (getExtTerminal() != NULL)
+	{
+		getExtTerminal()->pasteProgress(nSent, nSize, true);
+	}
+}
+
+/**
+ * Writes as much of the write queue as the master takes without blocking, in one writev
+ * per contiguous batch, topping the queue up from the paste in progress.
+ * The master is watched for writability while input remains.
+ * Must be called with the write lock held.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int Terminal::writeMaster()
+{
+	struct iovec vectors[2];
+	int nNumVectors;
+	ssize_t writeResult;
+	int result = 0;
+
+	if (m_bWriteInFlight)
+	{
+		//The backend writes the rest once the write in flight completes, keeping the input in order.
+		return 0;
+	}
+
+	while (true)
+	{
+		feedPaste();
+
+		if (m_writeBuffer->size() == 0)
+		{
+			break;
+		}
+
+		nNumVectors = m_writeBuffer->getReadVectors(vectors);
+		writeResult = writev(m_masterFD, vectors, nNumVectors);
+
+		if (writeResult < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				//Master is full. Wait for it to drain.
+				break;
+			}
+
+			Logger::getInstance()->warn("Cannot write to master.");
+
+			if (m_pasteData != NULL)
+			{
+				finishPaste();
+			}
+
+			m_writeBuffer->clear();
+			result = -1;
+			break;
+		}
+		else
+		{
+			m_writeBuffer->consume(writeResult);
+		}
+	}
+
+	if (m_writeBuffer->size() == 0 && m_writeBuffer->capacity() > MIN_WRITE_BUFFER_SIZE)
+	{
+		//Release the memory of a large paste.
+		m_writeBuffer->resize(MIN_WRITE_BUFFER_SIZE);
+	}
+
+	pthread_mutex_lock(&m_pipelineLock);
+	updateMasterEvents();
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	return result;
+}
+
+/**
+ * Copies the start of the write queue for a backend that writes the master asynchronously.
+ * The queue is left alone until completeWrite() says how much was written, and no other
+ * write is started meanwhile.
+ * Returns the number of bytes copied.
+ */
+size_t Terminal::prepareWrite(char *data, size_t size)
+{
+	struct iovec vectors[2];
+	int nNumVectors;
+	size_t nSize = 0;
+
+	pthread_mutex_lock(&m_writeLock);
+
+	feedPaste();
+
+	nNumVectors = m_writeBuffer->getReadVectors(vectors);
+
+	for (int i = 0; i < nNumVectors && nSize < size; i++)
+	{
+		size_t nLength = std::min(vectors[i].iov_len, size - nSize);
+
+		memcpy(data + nSize, vectors[i].iov_base, nLength);
+		nSize += nLength;
+	}
+
+	m_bWriteInFlight = (nSize > 0);
+
+	pthread_mutex_unlock(&m_writeLock);
+
+	return nSize;
+}
+
+/**
+ * Takes the result of an asynchronous write: the number of bytes written, or a negative
+ * error number. Written input leaves the queue, and the paste in progress is topped up.
+ */
+void Terminal::completeWrite(int result)
+{
+	pthread_mutex_lock(&m_writeLock);
+
+	m_bWriteInFlight = false;
+
+	if (result > 0)
+	{
+		m_writeBuffer->consume(result);
+	}
+	else if (result < 0 && result != -EINTR && result != -EAGAIN && result != -ECANCELED)
+	{
+		Logger::getInstance()->warn("Cannot write to master.");
+
+		if (m_pasteData != NULL)
+		{
+			finishPaste();
+		}
+
+		m_writeBuffer->clear();
+	}
+
+	feedPaste();
+
+	if (m_writeBuffer->size() == 0 && m_writeBuffer->capacity() > MIN_WRITE_BUFFER_SIZE)
+	{
+		//Release the memory of a large paste.
+		m_writeBuffer->resize(MIN_WRITE_BUFFER_SIZE);
+	}
+
+	pthread_mutex_lock(&m_pipelineLock);
+	updateMasterEvents();
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	pthread_mutex_unlock(&m_writeLock);
+}
+
+/**
+ * Starts the child process. The terminal is driven once it is added to a session manager.
+ * Returns 0 if success.
+ */
+int Terminal::start()
+{
+	Logger::getInstance()->info("Starting pseudo terminal.");
+
+	int result = spawnPTY();
+
+	if (result == 0)
+	{
+		Logger::getInstance()->info("Started pseudo terminal.");
+		setReady(true);
+	}
+
+	return result;
+}
+
+/**
+ * Reads everything available from the master without blocking, straight into the read ring.
+ * Each read is handed to the parser thread right away. If the parser falls behind and the
+ * ring fills up, reading stops until it catches up, leaving the rest of the output in the PTY.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int Terminal::readMaster()
+{
+	struct iovec vectors[2];
+	int nNumVectors;
+	ssize_t readResult;
+	size_t nBatchSize = 0;
+	int result = 0;
+
+	while(!m_bDone && !m_bReadPaused)
+	{
+		nNumVectors = m_readBuffer->getWriteVectors(vectors);
+
+		if (nNumVectors == 0)
+		{
+			//Ring is full. Grow it while the parser is idle, otherwise wait for the parser.
+			if (growReadBuffer() != 0)
+			{
+				pauseReading();
+
+				if (m_bReadPaused)
+				{
+					break;
+				}
+			}
+
+			continue;
+		}
+
+		readResult = readv(m_masterFD, vectors, nNumVectors);
+
+		if (readResult < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				//Nothing more to read.
+				break;
+			}
+
+			Logger::getInstance()->error("Cannot read pseudo terminal.");
+			result = -1;
+			stopReading();
+		}
+		else if (readResult == 0)
+		{
+			//EOF
+			stopReading();
+		}
+		else
+		{
+			m_readBuffer->commitWrite(readResult);
+			nBatchSize += readResult;
+			wakeParser();
+		}
+	}
+
+	adjustReadBuffer(nBatchSize);
+
+	return result;
+}
+
+/**
+ * Gets the free space of the read ring for a backend that reads the master asynchronously.
+ * A full ring is grown or reading is paused, the same way readMaster() does it. The ring is
+ * not resized until completeRead() is called.
+ * Returns the number of vectors, or 0 if there is nothing to read into.
+ */
+int Terminal::prepareRead(struct iovec *vectors)
+{
+	int nNumVectors;
+
+	while (!m_bDone && !m_bReadPaused)
+	{
+		nNumVectors = m_readBuffer->getWriteVectors(vectors);
+
+		if (nNumVectors > 0)
+		{
+			return nNumVectors;
+		}
+
+		if (growReadBuffer() != 0)
+		{
+			pauseReading();
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Takes the result of an asynchronous read: the number of bytes read into the ring, or a
+ * negative error number.
+ */
+void Terminal::completeRead(int result)
+{
+	if (result > 0)
+	{
+		m_readBuffer->commitWrite(result);
+		adjustReadBuffer(result);
+		wakeParser();
+	}
+	else if (result == 0)
+	{
+		//EOF
+		stopReading();
+	}
+	else if (result != -EINTR && result != -EAGAIN && result != -ECANCELED)
+	{
+		Logger::getInstance()->error("Cannot read pseudo terminal.");
+		stopReading();
+	}
+}
+
+/**
+ * Doubles the read ring, up to the maximum size. The ring can only be resized while
+ * the parser thread is not using it.
+ * Returns -1 if the ring cannot grow right now. Returns 0 if success.
+ */
+int Terminal::growReadBuffer()
+{
+	size_t capacity = m_readBuffer->capacity();
+	int result = -1;
+
+	pthread_mutex_lock(&m_pipelineLock);
+
+	if (!m_bParsing && capacity < MAX_READ_BUFFER_SIZE && m_readBuffer->resize(capacity * 2) == 0)
+	{
+		m_nSmallBatches = 0;
+		result = 0;
+	}
+
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	return result;
+}
+
+/**
+ * Sizes the read ring from the amount of output read in one go. The ring doubles when
+ * a batch fills it, and halves after a run of batches that hardly use it.
+ */
+void Terminal::adjustReadBuffer(size_t nBatchSize)
+{
+	size_t capacity = m_readBuffer->capacity();
+
+	if (nBatchSize >= capacity)
+	{
+		m_nSmallBatches = 0;
+		growReadBuffer();
+	}
+	else if (nBatchSize < (capacity / 16) && capacity > MIN_READ_BUFFER_SIZE)
+	{
+		if (++m_nSmallBatches >= SHRINK_READ_BUFFER_BATCHES)
+		{
+			pthread_mutex_lock(&m_pipelineLock);
+
+			if (!m_bParsing && m_readBuffer->resize(capacity / 2) == 0)
+			{
+				m_nSmallBatches = 0;
+			}
+
+			pthread_mutex_unlock(&m_pipelineLock);
+		}
+	}
+	else
+	{
+		m_nSmallBatches = 0;
+	}
+}
+
+/**
+ * Stops reading the master while the read ring is full, which is the high watermark. The
+ * output then backs up in the PTY until the child blocks writing. The parser thread wakes
+ * the reader once the ring is down to the low watermark, so that reading does not start and
+ * stop again for every batch parsed.
+ */
+void Terminal::pauseReading()
+{
+	pthread_mutex_lock(&m_pipelineLock);
+
+	//The parser may have made room since the ring was found full.
+	if (m_readBuffer->available() == 0)
+	{
+		m_bReadPaused = true;
+		updateMasterEvents();
+		sendFlowControl(true);
+	}
+
+	pthread_mutex_unlock(&m_pipelineLock);
+}
+
+/**
+ * Reads the master again after reading was paused.
+ */
+void Terminal::resumeReading()
+{
+	pthread_mutex_lock(&m_pipelineLock);
+
+	m_bReadPaused = false;
+	updateMasterEvents();
+	sendFlowControl(false);
+
+	pthread_mutex_unlock(&m_pipelineLock);
+}
+
+/**
+ * Checks whether the parser has drained the read ring down to the low watermark.
+ */
+bool Terminal::canResumeReading()
+{
+	return (m_readBuffer->size() <= m_readBuffer->capacity() / READ_RESUME_DIVISOR);
+}
+
+/**
+ * Sends XOFF to stop the output of the child, or XON to start it again, if enabled. The
+ * character goes straight to the master ahead of any queued input. It is only sent while the
+ * line discipline handles flow control; otherwise the child would read it as input.
+ * Must be called with the pipeline lock held.
+ */
+void Terminal::sendFlowControl(bool bStop)
+{
+	struct termios settings;
+	char c = bStop ? '\023' : '\021';
+
+	if (bStop ? (!m_bXOffEnabled || m_bXOffSent) : !m_bXOffSent)
+	{
+		return;
+	}
+
+	m_bXOffSent = false;
+
+	if (m_masterFD >= 0 && tcgetattr(m_masterFD, &settings) == 0 && (settings.c_iflag & IXON) != 0
+		&& write(m_masterFD, &c, 1) == 1)
+	{
+		m_bXOffSent = bStop;
+	}
+}
+
+/**
+ * Stops reading the master for good once the child is gone. The parser still gets
+ * whatever output is left in the read ring.
+ */
+void Terminal::stopReading()
+{
+	pthread_mutex_lock(&m_pipelineLock);
+
+	m_bDone = true;
+	updateMasterEvents();
+
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	wakeParser();
+}
+
+/**
+ * Watches the master for output unless reading is paused, and for writability while input
+ * is queued, and the child for exiting, through the I/O backend of the session manager.
+ * Must be called with the pipeline lock held.
+ */
+void Terminal::updateMasterEvents()
+{
+	int nEvents;
+
+	if (m_manager == NULL)
+	{
+		return;
+	}
+
+	nEvents = (m_bReadPaused ? 0 : PB_READ) | ((m_writeBuffer->size() > 0) ? PB_WRITE : 0);
+
+	if (m_bDone)
+	{
+		nEvents = 0;
+	}
+
+	if (m_pidFD >= 0 && !m_bExited)
+	{
+		nEvents |= PB_EXIT;
+	}
+
+	if (nEvents != m_nMasterEvents && m_manager->getBackend()->setEvents(this, nEvents) == 0)
+	{
+		m_nMasterEvents = nEvents;
+	}
+}
+
+/**
+ * Interrupts the reader thread if it is waiting for output.
+ */
+void Terminal::wakeReader()
+{
+	if (m_manager != NULL)
+	{
+		m_manager->wakeReader();
+	}
+}
+
+/**
+ * Tells the parser thread that there is output to parse.
+ */
+void Terminal::wakeParser()
+{
+	if (m_manager != NULL)
+	{
+		m_manager->wakeParser();
+	}
+}
+
+/**
+ * Checks whether there is output waiting and somewhere to put it.
+ */
+bool Terminal::hasOutput()
+{
+	return (m_readBuffer->size() > 0 && getExtTerminal() != NULL && getExtTerminal()->isReady());
+}
+
+/**
+ * Parses a batch of the output waiting in the read ring, then lets the reader go on if it was waiting
+ * for room. Must only be called from the parser thread.
+ */
+void Terminal::parseOutput()
+{
+	pthread_mutex_lock(&m_pipelineLock);
+	m_bParsing = true;
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	flushOutputBuffer();
+
+	pthread_mutex_lock(&m_pipelineLock);
+	m_bParsing = false;
+
+	if (m_bReadPaused && canResumeReading())
+	{
+		wakeReader();
+	}
+
+	pthread_mutex_unlock(&m_pipelineLock);
+}
+
+/**
+ * Hands the output in the read ring to the external terminal. The data is passed in place,
+ * in at most two slices, and may contain null characters. At most MAX_PARSE_SIZE bytes are
+ * passed in one go, so that the parser can take turns between terminals.
+ */
+void Terminal::flushOutputBuffer()
+{
+	struct iovec vectors[2];
+	int nNumVectors;
+	size_t nSize = 0;
+
+	//Transfer buffer to terminal state then flush buffer.
+	if (getExtTerminal() != NULL && getExtTerminal()->isReady())
+	{
+		nNumVectors = m_readBuffer->getReadVectors(vectors);
+
+		for (int i = 0; i < nNumVectors && nSize < MAX_PARSE_SIZE; i++)
+		{
+			size_t nLength = std::min(vectors[i].iov_len, MAX_PARSE_SIZE - nSize);
+
+			getExtTerminal()->insertData((const char *)vectors[i].iov_base, nLength);
+			nSize += nLength;
+		}
+
+		m_readBuffer->consume(nSize);
+	}
+}
+
+/**
+ * Sets the window size. Before the terminal starts, the size is applied to the TTY when
+ * it is initialized. Afterwards, it is set on the master right away, which signals the
+ * child with SIGWINCH.
+ */
+void Terminal::setWindowSize(int nWidth, int nHeight)
+{
+	if (nWidth < 0)
+	{
+		nWidth = 0;
+	}
+
+	if (nHeight < 0)
+	{
+		nHeight = 0;
+	}
+
+	if (m_winSize.ws_col == nWidth && m_winSize.ws_row == nHeight)
+	{
+		return;
+	}
+
+	m_winSize.ws_col = nWidth;
+	m_winSize.ws_row = nHeight;
+
+	if (isReady() && nWidth > 0 && nHeight > 0)
+	{
+		Logger::getInstance()->info("Resizing pseudo terminal to %dx%d.", nWidth, nHeight);
+
+		if (ioctl(m_masterFD, TIOCSWINSZ, &m_winSize) < 0)
+		{
+			Logger::getInstance()->error("Cannot set window size.");
+		}
+	}
+}
+
+/**
+ * Sets window size on the slave device, before the child process starts.
+ */
+int Terminal::setWindowSize()
+{
+	if (m_winSize.ws_col == 0 && m_winSize.ws_row == 0)
+	{
+		//No change.
+		return 0;
+	}
+
+	if (m_winSize.ws_col <= 0 || m_winSize.ws_row <= 0)
+	{
+		Logger::getInstance()->warn("Invalid window size.");
+		return -1;
+	}
+
+	if (ioctl(m_slaveFD, TIOCSWINSZ, &m_winSize) < 0)
+	{
+		Logger::getInstance()->error("Cannot set window size.");
+		return -1;
+	}
+
+	return 0;
+}
+
+int Terminal::setCBreak()
+{
+	struct termios settings;
+
+	if (tcgetattr(m_slaveFD, &settings) < 0)
+	{
+		Logger::getInstance()->error("Cannot read terminal settings.");
+		return -1;
+	}
+
+	settings.c_lflag &= ~ICANON;
+	settings.c_cc[VMIN] = 1;
+	settings.c_cc[VTIME] = 0;
+
+	if (tcsetattr(m_slaveFD, TCSANOW, &settings) < 0)
+	{
+		Logger::getInstance()->error("Cannot write CBreak terminal settings.");
+		return -2;
+	}
+
+	return 0;
+}
+
+int Terminal::setTermMode()
+{
+	struct termios settings;
+
+	if (tcgetattr(m_slaveFD, &settings) < 0)
+	{
+		Logger::getInstance()->error("Cannot read terminal settings.");
+		return -1;
+	}
+
+	settings.c_lflag = (ISIG | ICANON | ECHO | ECHOE | ECHOK);
+
+#ifdef ECHOKE
+	settings.c_lflag |= (ECHOKE | IEXTEN);
+#endif
+
+#ifdef ECHOCTL
+	settings.c_lflag |= (ECHOCTL | IEXTEN);
+#endif
+
+	settings.c_iflag = (ICRNL | IXON);
+	settings.c_cflag = (CS8 | CREAD | PARENB | HUPCL);
+
+#ifdef TAB3
+	settings.c_oflag = (OPOST | ONLCR | TAB3);
+#else
+	#ifdef ONLCR
+		settings.c_oflag = (OPOST | ONLCR);
+	#else
+		settings.c_oflag = OPOST;
+	#endif
+#endif
+
+	settings.c_cc[VMIN] = 1;
+	settings.c_cc[VTIME] = 0;
+
+	if (tcsetattr(m_slaveFD, TCSANOW, &settings) < 0)
+	{
+		Logger::getInstance()->error("Cannot write default terminal settings.");
+		return -2;
+	}
+
+	return 0;
+}
+
+int Terminal::setRaw()
+{
+	struct termios settings;
+
+	if (tcgetattr(m_slaveFD, &settings) < 0)
+	{
+		Logger::getInstance()->error("Cannot read terminal settings.");
+		return -1;
+	}
+
+	settings.c_lflag &= ~(ICANON | IEXTEN | ISIG);
+	settings.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+	settings.c_cflag &= ~(CSIZE | PARENB);
+	settings.c_cflag |= CS8;
+	settings.c_oflag &= ~(OPOST);
+	settings.c_cc[VMIN] = 1;
+	settings.c_cc[VTIME] = 0;
+
+	if (tcsetattr(m_slaveFD, TCSANOW, &settings) < 0)
+	{
+		Logger::getInstance()->error("Cannot write Raw terminal settings.");
+		return -2;
+	}
+
+	return 0;
+}
+
+void Terminal::insertData(const char *data, size_t size)
+{
+	if (size > 0)
+	{
+		sendCommand(data, size);
+	}
+}
+
+const char *Terminal::getUser()
+{
+	return m_sUser;
+}
+
+void Terminal::setUser(const char *sUser)
+{
+	if (sUser != NULL)
+	{
+		size_t userSize = (strlen(sUser) + 1) * sizeof(char);
+
+		m_sUser = (char *)realloc(m_sUser, userSize);
+		memcpy(m_sUser, sUser, userSize);
+	}
+}
+
+/**
+ * Sets the program the child process runs, as a NULL terminated argument list whose first
+ * entry is looked up in the path. NULL logs in as the user, which is the default.
+ * Takes effect the next time the terminal is started.
+ */
+void Terminal::setCommand(const char *const *command)
+{
+	if (m_command != NULL)
+	{
+		for (int i = 0; m_command[i] != NULL; i++)
+		{
+			free(m_command[i]);
+		}
+
+		free(m_command);
+		m_command = NULL;
+	}
+
+	if (command != NULL && command[0] != NULL)
+	{
+		int nNumArgs = 0;
+
+		while (command[nNumArgs] != NULL)
+		{
+			nNumArgs++;
+		}
+
+		m_command = (char **)malloc((nNumArgs + 1) * sizeof(char *));
+
+		for (int i = 0; i < nNumArgs; i++)
+		{
+			m_command[i] = strdup(command[i]);
+		}
+
+		m_command[nNumArgs] = NULL;
+	}
+}
+
+/**
+ * Sets whether pausing to let the parser catch up also sends XOFF to the child, and XON when
+ * reading resumes. Off by default; not reading the master is enough to stop the child, but
+ * only once the PTY has filled up.
+ */
+void Terminal::setXOffEnabled(bool bEnabled)
+{
+	m_bXOffEnabled = bEnabled;
+}
+
+/**
+ * Reaps the child if it exited, and keeps its exit status. A child that is gone without
+ * a status, because something else reaped it, counts as exited too.
+ * Returns true if the child was reaped.
+ */
+bool Terminal::waitChild(int nOptions)
+{
+	int nStatus;
+	pid_t result;
+
+	//Without a pidfd, more than one thread may poll; only the first may take the status.
+	pthread_mutex_lock(&m_pipelineLock);
+
+	if (!m_bExited)
+	{
+		do
+		{
+			result = waitpid(m_pid, &nStatus, nOptions);
+		} while (result < 0 && errno == EINTR);
+
+		if (result == m_pid)
+		{
+			m_nExitStatus = nStatus;
+			m_bExited = true;
+		}
+		else if (result < 0 && errno == ECHILD)
+		{
+			m_bExited = true;
+		}
+	}
+
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	return m_bExited;
+}
+
+/**
+ * Reaps the child once its pidfd became readable. Called from the reader thread. The exit is
+ * reported to the external terminal by the parser thread, after the output the child left
+ * behind in the PTY was parsed.
+ */
+void Terminal::reapChild()
+{
+	if (!m_bExited && m_pid > 0)
+	{
+		waitChild(WNOHANG);
+	}
+
+	pthread_mutex_lock(&m_pipelineLock);
+	updateMasterEvents();
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	wakeParser();
+}
+
+/**
+ * Stops driving the terminal and closes the PTY. Closing the master hangs up the session
+ * of the child, which should then exit.
+ */
+void Terminal::hangUp()
+{
+	if (m_manager != NULL)
+	{
+		m_manager->removeTerminal(this);
+	}
+
+	//Only the last terminal started saved its settings.
+	if (m_slaveFD >= 0 && terminal_global_slave_fd == m_slaveFD)
+	{
+		terminal_restore_settings();
+		terminal_global_slave_fd = -1;
+	}
+
+	if (m_masterFD >= 0)
+	{
+		close(m_masterFD);
+		m_masterFD = -1;
+	}
+
+	if (m_slaveFD >= 0)
+	{
+		close(m_slaveFD);
+		m_slaveFD = -1;
+	}
+}
+
+/**
+ * Makes sure the child does not outlive the terminal as a zombie.
+ */
+void Terminal::stopChild()
+{
+	std::vector<Terminal *> terminals(1, this);
+
+	stopChildren(terminals);
+}
+
+/**
+ * Makes sure the children of terminals that were hung up do not outlive them as zombies.
+ * Children that ignore the hangup share one moment to exit before they are killed, so
+ * stopping many terminals takes no longer than stopping one. Children without a pidfd
+ * are polled for.
+ */
+void Terminal::stopChildren(const std::vector<Terminal *> &terminals)
+{
+	std::vector<Terminal *> running;
+	std::vector<struct pollfd> fds;
+	struct pollfd fd;
+	struct timeval start, now;
+	int nRemainingMsec;
+	bool bPolled;
+
+	gettimeofday(&start, NULL);
+
+	while (true)
+	{
+		running.clear();
+		fds.clear();
+		bPolled = false;
+
+		for (size_t i = 0; i < terminals.size(); i++)
+		{
+			Terminal *terminal = terminals[i];
+
+			if (terminal->m_pid <= 0 || terminal->waitChild(WNOHANG))
+			{
+				continue;
+			}
+
+			running.push_back(terminal);
+
+			if (terminal->m_pidFD >= 0)
+			{
+				fd.fd = terminal->m_pidFD;
+				fd.events = POLLIN;
+				fd.revents = 0;
+				fds.push_back(fd);
+			}
+			else
+			{
+				bPolled = true;
+			}
+		}
+
+		gettimeofday(&now, NULL);
+		nRemainingMsec = EXIT_WAIT_MSEC - (int)((now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000);
+
+		if (running.empty() || nRemainingMsec <= 0)
+		{
+			break;
+		}
+
+		poll(fds.empty() ? NULL : &fds[0], fds.size(), bPolled ? std::min(nRemainingMsec, EXIT_POLL_MSEC) : nRemainingMsec);
+	}
+
+	//The child leads its own process group, along with whatever it started in the foreground.
+	for (size_t i = 0; i < running.size(); i++)
+	{
+		kill(-running[i]->m_pid, SIGKILL);
+	}
+
+	for (size_t i = 0; i < running.size(); i++)
+	{
+		running[i]->waitChild(0);
+	}
+}
+
+/**
+ * Checks whether the child exited and all of its output was parsed, but the external
+ * terminal was not told yet. Called from the parser thread.
+ */
+bool Terminal::isExitPending()
+{
+	return (!m_bExitReported && getExtTerminal() != NULL && isDone());
+}
+
+/**
+ * Checks whether the exit of the child can only be noticed by polling for it, because the
+ * kernel cannot give a pidfd to wait for. Called from the parser thread.
+ */
+bool Terminal::isExitPolled()
+{
+	return (m_pidFD < 0 && m_pid > 0 && !m_bExited && getExtTerminal() != NULL);
+}
+
+/**
+ * Tells the external terminal that the child exited. Called from the parser thread.
+ */
+void Terminal::reportExit()
+{
+	m_bExitReported = true;
+	getExtTerminal()->childExited(m_nExitStatus);
+}
+
+/**
+ * Returns true once the child process exited. The child is reaped the first time. When the
+ * kernel has a pidfd, the reader thread reaps the child as soon as it exits, so this only
+ * polls for terminals that are not driven by a session manager, or have no pidfd.
+ */
+bool Terminal::hasExited()
+{
+	if (!m_bExited && m_pid > 0 && (m_pidFD < 0 || m_manager == NULL))
+	{
+		waitChild(WNOHANG);
+	}
+
+	return m_bExited;
+}
+
+/**
+ * Returns true once the child is gone and all of its output was read and parsed.
+ */
+bool Terminal::isDone()
+{
+	int nPending = 0;
+	bool bDone;
+
+	if (!m_bDone && !hasExited())
+	{
+		return false;
+	}
+
+	//Output the child wrote before exiting may still be in the pseudo terminal.
+	if (!m_bDone && m_masterFD >= 0 && ioctl(m_masterFD, FIONREAD, &nPending) == 0 && nPending > 0)
+	{
+		return false;
+	}
+
+	pthread_mutex_lock(&m_pipelineLock);
+	bDone = !m_bParsing && m_readBuffer->size() == 0;
+	pthread_mutex_unlock(&m_pipelineLock);
+
+	return bDone;
+}
+
+/**
+ * Gets the status the child exited with, as returned by waitpid.
+ * Returns -1 if the child is still running, or its status is unknown.
+ */
+int Terminal::getExitStatus()
+{
+	return m_nExitStatus;
+}
@@ -1,79 +1,152 @@
-/**
- * This file is part of SDLTerminal.
- * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
- *
- * SDLTerminal is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * SDLTerminal is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
-
- * You should have received a copy of the GNU General Public License
- * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef TERMINAL_HPP__
-#define TERMINAL_HPP__
-
-#include <pthread.h>
-#include <termios.h>
-
-#ifndef TIOCGWINSZ
-#include <sys/ioctl.h>
-#endif
-
-#include "extterminal.hpp"
-#include "util/databuffer.hpp"
-
-class Terminal : public ExtTerminal, public ExtTerminalContainer
-{
-private:
-	int m_masterFD;
-	int m_slaveFD;
-	bool m_bDone;
-	int m_nWritePriority;
-	pid_t m_pid;
-	char *m_slaveName;
-	char *m_sUser;
-	DataBuffer *m_dataBuffer;
-
-	pthread_t m_readerThread;
-	pthread_mutexattr_t m_masterLockAttr;
-	pthread_mutex_t m_masterLock; //Mutex lock for the master FD.
-	struct winsize m_winSize;
-
-	int openPTYMaster();
-	int openPTYSlave();
-	int forkPTY();
-	int setRaw();
-	int setCBreak();
-	int setTermMode();
-	int setWindowSize();
-	int setFlag(int fileDesc, int flag);
-	bool isChild();
-
-	int runReader();
-	int startReaderThread();
-	static void *readerThread(void *terminal);
-
-	int sendCommand(const char *command);
-
-public:
-	Terminal();
-	virtual ~Terminal();
-
-	void setWindowSize(int nWidth, int nHeight);
-	int start();
-
-	void insertData(const char *data, size_t size);
-	void flushOutputBuffer();
-
-	const char *getUser();
-	void setUser(const char *sUser);
-};
-
-#endif
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TERMINAL_HPP__
+#define TERMINAL_HPP__
+
+#include <pthread.h>
+#include <sys/uio.h>
+#include <termios.h>
+
+#ifndef TIOCGWINSZ
+#include <sys/ioctl.h>
+#endif
+
+#include <vector>
+
+#include "extterminal.hpp"
+#include "util/ringbuffer.hpp"
+
+class SessionManager;
+
+/**
+ * A pseudo terminal running a child process. Input and output are driven by the
+ * session manager it is added to.
+ */
+class Terminal : public ExtTerminal, public ExtTerminalContainer
+{
+	friend class SessionManager;
+	friend class EpollBackend;
+	friend class UringBackend;
+
+private:
+	static const size_t MIN_READ_BUFFER_SIZE;
+	static const size_t MAX_READ_BUFFER_SIZE;
+	static const size_t READ_RESUME_DIVISOR;
+	static const int SHRINK_READ_BUFFER_BATCHES;
+	static const size_t MIN_WRITE_BUFFER_SIZE;
+	static const size_t PASTE_CHUNK_SIZE;
+	static const size_t MAX_PARSE_SIZE;
+	static const int EXIT_WAIT_MSEC;
+	static const int EXIT_POLL_MSEC;
+
+	int m_masterFD;
+	int m_slaveFD;
+	SessionManager *m_manager; //Drives the input and output. NULL until added to one.
+	bool m_bDone; //The child is gone. Nothing more is read.
+	int m_nMasterEvents; //Events currently watched on the master.
+	pid_t m_pid;
+	int m_pidFD; //Readable once the child exits. -1 if the kernel has no pidfd; exiting is then polled for.
+	bool m_bExited; //The child process exited and was reaped.
+	int m_nExitStatus; //Status of the child as returned by waitpid, or -1 until it exited.
+	bool m_bExitReported; //The external terminal was told that the child exited.
+	char m_slaveName[64];
+	char *m_sUser;
+	char **m_command; //Arguments of the child process. NULL to log in as the user.
+	RingBuffer *m_readBuffer; //Output read from the master, waiting to be parsed.
+	int m_nSmallBatches; //Consecutive reads that used little of the read buffer.
+	bool m_bParsing; //The parser thread is consuming the read buffer.
+	bool m_bReadPaused; //Reading stopped until the parser thread frees up the read buffer.
+	bool m_bXOffEnabled; //Pausing also sends XOFF, so the child stops before the PTY fills up.
+	bool m_bXOffSent; //XOFF was sent and XON is owed once reading resumes.
+	RingBuffer *m_writeBuffer; //Input waiting for the master to accept it.
+	bool m_bWriteInFlight; //The start of the write queue is being written asynchronously.
+	char *m_pasteData; //Paste in progress, fed into the write queue a chunk at a time.
+	size_t m_nPasteSize;
+	size_t m_nPasteSent;
+	bool m_bPasteBracketed;
+
+	pthread_mutex_t m_pipelineLock; //Mutex lock for the hand off between the reader and parser threads.
+	pthread_mutexattr_t m_writeLockAttr;
+	pthread_mutex_t m_writeLock; //Mutex lock for the write queue and paste.
+	struct winsize m_winSize;
+
+	int openPTYMaster();
+	int openPTYSlave();
+	int spawnPTY();
+	int setRaw();
+	int setCBreak();
+	int setTermMode();
+	int setWindowSize();
+	int setFlag(int fileDesc, int flag);
+
+	int readMaster();
+	int prepareRead(struct iovec *vectors);
+	void completeRead(int result);
+	int growReadBuffer();
+	void adjustReadBuffer(size_t nBatchSize);
+	void pauseReading();
+	void resumeReading();
+	bool canResumeReading();
+	void sendFlowControl(bool bStop);
+	void stopReading();
+	int writeMaster();
+	size_t prepareWrite(char *data, size_t size);
+	void completeWrite(int result);
+	int queueWrite(const char *data, size_t size);
+	void feedPaste();
+	void finishPaste();
+	void updateMasterEvents();
+	void wakeReader();
+	void wakeParser();
+	bool hasOutput();
+	void parseOutput();
+	void flushOutputBuffer();
+
+	bool waitChild(int nOptions);
+	void reapChild();
+	void hangUp();
+	void stopChild();
+	static void stopChildren(const std::vector<Terminal *> &terminals);
+	bool isExitPending();
+	bool isExitPolled();
+	void reportExit();
+
+	int sendCommand(const char *command, size_t size);
+
+public:
+	Terminal();
+	virtual ~Terminal();
+
+	void setWindowSize(int nWidth, int nHeight);
+	int start();
+
+	void insertData(const char *data, size_t size);
+	void pasteData(const char *data, size_t size, bool bBracketed);
+	void cancelPaste();
+
+	const char *getUser();
+	void setUser(const char *sUser);
+	void setCommand(const char *const *command);
+	void setXOffEnabled(bool bEnabled);
+	bool hasExited();
+	bool isDone();
+	int getExitStatus();
+};
+
+#endif
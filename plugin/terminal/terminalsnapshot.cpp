@@ -0,0 +1,592 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "terminalsnapshot.hpp"
+
+#include "util/logger.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+typedef enum
+{
+	TSS_LINE_BLANK = 0,
+	TSS_LINE_DATA,
+	TSS_LINE_REPEAT
+} TSSLineTag_t;
+
+const unsigned int TerminalSnapshot::MAGIC = 0x53545758; //"XWTS"
+const unsigned int TerminalSnapshot::END_MAGIC = 0x444E4558; //"XEND"
+const size_t TerminalSnapshot::CHUNK_SIZE = 4096;
+const size_t TerminalSnapshot::MAX_LINE_SIZE = (1024 * 1024);
+const int TerminalSnapshot::MAX_LINES = (1024 * 1024 * 16);
+const int TerminalSnapshot::MAX_SCREEN_SIZE = 65535;
+const int TerminalSnapshot::VERSION = 2; //Version 2 has 64 bit line numbers.
+
+TerminalSnapshot::TerminalSnapshot(FILE *file)
+{
+	m_file = file;
+	m_chunk = (char *)malloc(CHUNK_SIZE);
+	m_bError = (m_file == NULL || m_chunk == NULL);
+	m_nMaxHistoryLines = -1;
+}
+
+TerminalSnapshot::~TerminalSnapshot()
+{
+	free(m_chunk);
+}
+
+/**
+ * Limits how many of the most recent history lines are saved. Older lines are left out,
+ * as if they had been evicted. Negative saves all of them, which is the default.
+ */
+void TerminalSnapshot::setMaxHistoryLines(int nMaxLines)
+{
+	m_nMaxHistoryLines = nMaxLines;
+}
+
+void TerminalSnapshot::writeBytes(const void *data, size_t size)
+{
+	if (!m_bError && size > 0 && fwrite(data, 1, size, m_file) != size)
+	{
+		m_bError = true;
+	}
+}
+
+void TerminalSnapshot::writeInt(int nValue)
+{
+	unsigned char buffer[4];
+
+	for (int i = 0; i < sizeof(buffer); i++)
+	{
+		buffer[i] = (((unsigned int)nValue) >> (i * 8)) & 0xFF;
+	}
+
+	writeBytes(buffer, sizeof(buffer));
+}
+
+void TerminalSnapshot::writeSize(size_t nValue)
+{
+	writeInt(nValue & 0xFFFFFFFF);
+	writeInt((sizeof(size_t) > 4) ? ((nValue >> 16) >> 16) : 0);
+}
+
+void TerminalSnapshot::writeInt64(int64_t nValue)
+{
+	writeInt((uint64_t)nValue & 0xFFFFFFFF);
+	writeInt((uint64_t)nValue >> 32);
+}
+
+void TerminalSnapshot::writeGraphicsState(const TSLineGraphicsState_t &state)
+{
+	writeInt(state.foregroundColor);
+	writeInt(state.backgroundColor);
+	writeInt(state.nColumn);
+	writeInt(state.nLine);
+	writeInt(state.nGraphicsMode);
+}
+
+/**
+ * Writes a line. Blank lines and lines sharing the data of the previous line
+ * only take a tag.
+ */
+void TerminalSnapshot::writeLine(DataBuffer *line, DataBuffer *prevLine)
+{
+	unsigned char tag;
+
+	if (line->size() == 0)
+	{
+		tag = TSS_LINE_BLANK;
+		writeBytes(&tag, 1);
+	}
+	else if (line == prevLine)
+	{
+		tag = TSS_LINE_REPEAT;
+		writeBytes(&tag, 1);
+	}
+	else
+	{
+		size_t nSize = line->size();
+
+		tag = TSS_LINE_DATA;
+		writeBytes(&tag, 1);
+		writeInt(nSize);
+
+		for (size_t nOffset = 0; nOffset < nSize && !m_bError; nOffset += CHUNK_SIZE)
+		{
+			size_t nChunkSize = ((nSize - nOffset) < CHUNK_SIZE) ? (nSize - nOffset) : CHUNK_SIZE;
+
+			line->copy(nOffset, m_chunk, nChunkSize);
+			writeBytes(m_chunk, nChunkSize);
+		}
+	}
+}
+
+void TerminalSnapshot::readBytes(void *data, size_t size)
+{
+	if (m_bError || size == 0)
+	{
+		return;
+	}
+
+	if (fread(data, 1, size, m_file) != size)
+	{
+		memset(data, 0, size);
+		m_bError = true;
+	}
+}
+
+int TerminalSnapshot::readInt()
+{
+	unsigned char buffer[4];
+	unsigned int nValue = 0;
+
+	readBytes(buffer, sizeof(buffer));
+
+	for (int i = sizeof(buffer) - 1; i >= 0; i--)
+	{
+		nValue = (nValue << 8) | buffer[i];
+	}
+
+	return (int)nValue;
+}
+
+size_t TerminalSnapshot::readSize()
+{
+	size_t nLow = (unsigned int)readInt();
+	size_t nHigh = (unsigned int)readInt();
+
+	if (sizeof(size_t) <= 4)
+	{
+		//Does not fit. Saturate instead of wrapping around.
+		return (nHigh > 0) ? (size_t)-1 : nLow;
+	}
+
+	return ((nHigh << 16) << 16) | nLow;
+}
+
+int64_t TerminalSnapshot::readInt64()
+{
+	uint64_t nLow = (unsigned int)readInt();
+	uint64_t nHigh = (unsigned int)readInt();
+
+	return (int64_t)((nHigh << 32) | nLow);
+}
+
+void TerminalSnapshot::readGraphicsState(TSLineGraphicsState_t &state)
+{
+	int nForegroundColor = readInt();
+	int nBackgroundColor = readInt();
+
+	if (nForegroundColor < 0 || nForegroundColor >= TS_COLOR_MAX
+		|| nBackgroundColor < 0 || nBackgroundColor >= TS_COLOR_MAX)
+	{
+		m_bError = true;
+	}
+
+	state.foregroundColor = (TSColor_t)nForegroundColor;
+	state.backgroundColor = (TSColor_t)nBackgroundColor;
+	state.nColumn = readInt();
+	state.nLine = readInt();
+	state.nGraphicsMode = readInt();
+}
+
+/**
+ * Reads a line. Returns the blank line for a blank line, and the previous line with
+ * an extra reference for a repeated line. Returns NULL if an error occurs.
+ */
+DataBuffer *TerminalSnapshot::readLine(DataBuffer *prevLine)
+{
+	unsigned char tag = TSS_LINE_BLANK;
+
+	readBytes(&tag, 1);
+
+	if (m_bError)
+	{
+		return NULL;
+	}
+
+	if (tag == TSS_LINE_BLANK)
+	{
+		return TerminalState::s_blankLine;
+	}
+	else if (tag == TSS_LINE_REPEAT && prevLine != NULL)
+	{
+		if (prevLine != TerminalState::s_blankLine)
+		{
+			prevLine->addRef();
+		}
+
+		return prevLine;
+	}
+	else if (tag != TSS_LINE_DATA)
+	{
+		m_bError = true;
+		return NULL;
+	}
+
+	size_t nSize = (unsigned int)readInt();
+
+	if (nSize == 0 || nSize > MAX_LINE_SIZE)
+	{
+		m_bError = true;
+		return NULL;
+	}
+
+	DataBuffer *line = new DataBuffer();
+
+	for (size_t nOffset = 0; nOffset < nSize && !m_bError; nOffset += CHUNK_SIZE)
+	{
+		size_t nChunkSize = ((nSize - nOffset) < CHUNK_SIZE) ? (nSize - nOffset) : CHUNK_SIZE;
+
+		readBytes(m_chunk, nChunkSize);
+
+		if (!m_bError && line->append(m_chunk, nChunkSize) != 0)
+		{
+			m_bError = true;
+		}
+	}
+
+	if (m_bError)
+	{
+		delete line;
+		return NULL;
+	}
+
+	line->compact();
+
+	return line;
+}
+
+/**
+ * Writes the terminal state to the file.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int TerminalSnapshot::save(TerminalState *state)
+{
+	int nSkipped = 0;
+
+	if (state == NULL || m_bError)
+	{
+		return -1;
+	}
+
+	state->lock();
+
+	if (m_nMaxHistoryLines >= 0 && state->m_nTopBufferLine > m_nMaxHistoryLines)
+	{
+		nSkipped = state->m_nTopBufferLine - m_nMaxHistoryLines;
+	}
+
+	writeInt(MAGIC);
+	writeInt(VERSION);
+
+	writeInt(state->m_nTermModeFlags);
+	writeInt(state->m_charset);
+	writeInt(state->m_bShiftText);
+	writeInt(state->m_cursorLoc.getX());
+	writeInt(state->m_cursorLoc.getY());
+	writeInt(state->m_displayScreenSize.getX());
+	writeInt(state->m_displayScreenSize.getY());
+	writeInt(state->m_nTopMargin);
+	writeInt(state->m_nBottomMargin);
+	writeInt(state->m_nNumBufferLines);
+	writeInt(state->m_nTopBufferLine - nSkipped);
+	writeInt64(state->m_nFirstLineNumber + nSkipped);
+	writeSize(state->m_nMemoryBudget);
+	writeInt(state->m_bShareLines);
+	writeInt(state->m_searchIndex != NULL);
+
+	writeGraphicsState(state->m_defaultGraphicsState);
+	writeGraphicsState(state->m_currentGraphicsState);
+	writeGraphicsState(state->m_savedGraphicsState);
+
+	writeInt(state->m_graphicsState.size());
+
+	for (int i = 0; i < state->m_graphicsState.size(); i++)
+	{
+		writeGraphicsState(*(state->m_graphicsState[i]));
+	}
+
+	writeInt(state->m_data.size() - nSkipped);
+
+	for (int i = nSkipped; i < state->m_data.size() && !m_bError; i++)
+	{
+		writeLine(state->m_data[i], (i > nSkipped) ? state->m_data[i - 1] : NULL);
+	}
+
+	state->unlock();
+
+	writeInt(END_MAGIC);
+
+	if (!m_bError && fflush(m_file) != 0)
+	{
+		m_bError = true;
+	}
+
+	if (m_bError)
+	{
+		Logger::getInstance()->error("Cannot write terminal snapshot.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Replaces the terminal state with the one read from the file.
+ * The terminal state is left untouched if the file cannot be read, or if the cursor,
+ * margins or graphics states lie outside of the display.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int TerminalSnapshot::load(TerminalState *state)
+{
+	std::deque<DataBuffer *> lines;
+	std::vector<TSLineGraphicsState_t *> graphicsStates;
+	TSLineGraphicsState_t defaultState, currentState, savedState;
+	int nNumLines, nNumStates;
+
+	if (state == NULL || m_bError)
+	{
+		return -1;
+	}
+
+	if (readInt() != MAGIC)
+	{
+		Logger::getInstance()->error("Not a terminal snapshot.");
+		return -1;
+	}
+
+	int nVersion = readInt();
+
+	if (nVersion < 1 || nVersion > VERSION)
+	{
+		Logger::getInstance()->error("Unsupported terminal snapshot version %d.", nVersion);
+		return -1;
+	}
+
+	int nTermModeFlags = readInt();
+	int nCharset = readInt();
+	bool bShiftText = (readInt() != 0);
+	int nCursorX = readInt();
+	int nCursorY = readInt();
+	int nWidth = readInt();
+	int nHeight = readInt();
+	int nTopMargin = readInt();
+	int nBottomMargin = readInt();
+	int nNumBufferLines = readInt();
+	int nTopBufferLine = readInt();
+	int64_t nFirstLineNumber = (nVersion >= 2) ? readInt64() : readInt();
+	size_t nMemoryBudget = readSize();
+	bool bShareLines = (readInt() != 0);
+	bool bSearchIndex = (readInt() != 0);
+
+	readGraphicsState(defaultState);
+	readGraphicsState(currentState);
+	readGraphicsState(savedState);
+
+	if (nCharset < 0 || nCharset >= TS_CS_MAX || nWidth < 1 || nHeight < 1
+		|| nWidth > MAX_SCREEN_SIZE || nHeight > MAX_SCREEN_SIZE
+		|| nTopBufferLine < 0 || nNumBufferLines < nHeight || nNumBufferLines > MAX_LINES
+		|| nCursorX < 1 || nCursorX > (nWidth + 1) || nCursorY < 1 || nCursorY > nHeight
+		|| nTopMargin < 1 || nBottomMargin <= nTopMargin || nBottomMargin > nHeight)
+	{
+		m_bError = true;
+	}
+
+	nNumStates = readInt();
+
+	if (nNumStates < 0 || nNumStates > MAX_LINES)
+	{
+		m_bError = true;
+	}
+
+	for (int i = 0; i < nNumStates && !m_bError; i++)
+	{
+		TSLineGraphicsState_t *graphicsState = (TSLineGraphicsState_t *)malloc(sizeof(TSLineGraphicsState_t));
+
+		if (graphicsState == NULL)
+		{
+			m_bError = true;
+			break;
+		}
+
+		readGraphicsState(*graphicsState);
+		graphicsStates.push_back(graphicsState);
+
+		//Graphics states are located on the display.
+		if (graphicsState->nColumn < 1 || graphicsState->nColumn > (nWidth + 1)
+			|| graphicsState->nLine < 1 || graphicsState->nLine > nHeight)
+		{
+			m_bError = true;
+		}
+	}
+
+	nNumLines = readInt();
+
+	if (nNumLines < (nTopBufferLine + nHeight) || nNumLines > nNumBufferLines)
+	{
+		m_bError = true;
+	}
+
+	for (int i = 0; i < nNumLines && !m_bError; i++)
+	{
+		DataBuffer *line = readLine(lines.empty() ? NULL : lines.back());
+
+		if (line != NULL)
+		{
+			lines.push_back(line);
+		}
+	}
+
+	if (readInt() != END_MAGIC)
+	{
+		m_bError = true;
+	}
+
+	if (m_bError)
+	{
+		Logger::getInstance()->error("Cannot read terminal snapshot.");
+
+		for (int i = 0; i < lines.size(); i++)
+		{
+			if (lines[i] != TerminalState::s_blankLine && lines[i]->removeRef() <= 0)
+			{
+				delete lines[i];
+			}
+		}
+
+		for (int i = 0; i < graphicsStates.size(); i++)
+		{
+			free(graphicsStates[i]);
+		}
+
+		return -1;
+	}
+
+	state->lock();
+
+	state->enableSearchIndex(false);
+	state->enableLineSharing(false);
+	state->freeBuffer();
+	state->freeGraphicsMode();
+
+	state->m_nTermModeFlags = nTermModeFlags;
+	state->m_charset = (TSCharset_t)nCharset;
+	state->m_bShiftText = bShiftText;
+	state->m_displayScreenSize = Point(nWidth, nHeight);
+	state->m_nNumBufferLines = nNumBufferLines;
+	state->m_nTopBufferLine = nTopBufferLine;
+	state->m_nFirstLineNumber = nFirstLineNumber;
+	state->m_nMemoryBudget = nMemoryBudget;
+	state->m_defaultGraphicsState = defaultState;
+	state->m_currentGraphicsState = currentState;
+	state->m_savedGraphicsState = savedState;
+	state->m_data.swap(lines);
+	state->m_graphicsState.swap(graphicsStates);
+
+	state->setMargin(nTopMargin, nBottomMargin);
+	state->m_cursorLoc = Point(nCursorX, nCursorY); //Setting the margins homes the cursor.
+	state->enableLineSharing(bShareLines);
+	state->commitHistoryLines(0, state->m_nTopBufferLine);
+	state->enableSearchIndex(bSearchIndex);
+	state->enforceMemoryBudget();
+
+	state->unlock();
+
+	return 0;
+}
+
+/**
+ * Writes the terminal state to the named file. The file is replaced only once the
+ * snapshot is complete, so an interrupted save never leaves a partial snapshot behind.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int TerminalSnapshot::save(TerminalState *state, const char *sFileName)
+{
+	int nResult = -1;
+	size_t nSize = strlen(sFileName) + 5;
+	char *sTmpFileName = (char *)malloc(nSize);
+
+	if (sTmpFileName == NULL)
+	{
+		return -1;
+	}
+
+	snprintf(sTmpFileName, nSize, "%s.tmp", sFileName);
+
+	FILE *file = fopen(sTmpFileName, "wb");
+
+	if (file == NULL)
+	{
+		Logger::getInstance()->error("Cannot create terminal snapshot: '%s'", sTmpFileName);
+	}
+	else
+	{
+		TerminalSnapshot snapshot(file);
+
+		nResult = snapshot.save(state);
+
+		if (fclose(file) != 0)
+		{
+			nResult = -1;
+		}
+
+		if (nResult == 0 && rename(sTmpFileName, sFileName) != 0)
+		{
+			Logger::getInstance()->error("Cannot replace terminal snapshot: '%s'", sFileName);
+			nResult = -1;
+		}
+
+		if (nResult != 0)
+		{
+			remove(sTmpFileName);
+		}
+	}
+
+	free(sTmpFileName);
+
+	return nResult;
+}
+
+/**
+ * Replaces the terminal state with the one read from the named file.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int TerminalSnapshot::load(TerminalState *state, const char *sFileName)
+{
+	int nResult = -1;
+	FILE *file = fopen(sFileName, "rb");
+
+	if (file == NULL)
+	{
+		Logger::getInstance()->error("Cannot read terminal snapshot: '%s'", sFileName);
+	}
+	else
+	{
+		TerminalSnapshot snapshot(file);
+
+		nResult = snapshot.load(state);
+		fclose(file);
+	}
+
+	return nResult;
+}
@@ -0,0 +1,75 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TERMINALSNAPSHOT_HPP__
+#define TERMINALSNAPSHOT_HPP__
+
+#include "terminalstate.hpp"
+
+#include <stdio.h>
+
+/**
+ * Saves and restores the complete state of a terminal in a compact binary format.
+ * Lines are streamed one at a time, so memory use does not grow with the scrollback.
+ * Numbers are stored little endian, so a snapshot can be read on any host.
+ */
+class TerminalSnapshot
+{
+private:
+	static const unsigned int MAGIC;
+	static const unsigned int END_MAGIC;
+	static const size_t CHUNK_SIZE;
+	static const size_t MAX_LINE_SIZE;
+	static const int MAX_LINES;
+	static const int MAX_SCREEN_SIZE;
+
+	FILE *m_file;
+	char *m_chunk;
+	bool m_bError;
+	int m_nMaxHistoryLines; //History lines to save, or -1 for all of them.
+
+	void writeBytes(const void *data, size_t size);
+	void writeInt(int nValue);
+	void writeSize(size_t nValue);
+	void writeInt64(int64_t nValue);
+	void writeGraphicsState(const TSLineGraphicsState_t &state);
+	void writeLine(DataBuffer *line, DataBuffer *prevLine);
+
+	void readBytes(void *data, size_t size);
+	int readInt();
+	size_t readSize();
+	int64_t readInt64();
+	void readGraphicsState(TSLineGraphicsState_t &state);
+	DataBuffer *readLine(DataBuffer *prevLine);
+
+public:
+	static const int VERSION;
+
+	TerminalSnapshot(FILE *file);
+	~TerminalSnapshot();
+
+	void setMaxHistoryLines(int nMaxLines);
+
+	int save(TerminalState *state);
+	int load(TerminalState *state);
+
+	static int save(TerminalState *state, const char *sFileName);
+	static int load(TerminalState *state, const char *sFileName);
+};
+
+#endif
@@ -0,0 +1,577 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "uringbackend.hpp"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef USE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#include "sessionmanager.hpp"
+#include "terminal.hpp"
+#include "util/logger.hpp"
+
+const unsigned int UringBackend::QUEUE_SIZE = 256;
+const size_t UringBackend::WRITE_SIZE = (4 * 1024);
+
+UringBackend::UringBackend(SessionManager *manager) : PTYBackend(manager)
+{
+	m_ringFD = -1;
+	m_sqRing = NULL;
+	m_nSQRingSize = 0;
+	m_cqRing = NULL;
+	m_nCQRingSize = 0;
+	m_sqes = NULL;
+	m_nSQEsSize = 0;
+	m_sqHead = NULL;
+	m_sqTail = NULL;
+	m_sqArray = NULL;
+	m_nSQMask = 0;
+	m_nSQEntries = 0;
+	m_cqHead = NULL;
+	m_cqTail = NULL;
+	m_cqes = NULL;
+	m_nCQMask = 0;
+	m_nToSubmit = 0;
+	m_wakeValue = 0;
+	m_bRunning = false;
+
+	pthread_mutex_init(&m_lock, NULL);
+}
+
+UringBackend::~UringBackend()
+{
+	std::map<Terminal *, UBTerminal_t>::iterator itr;
+
+	for (itr = m_terminals.begin(); itr != m_terminals.end(); itr++)
+	{
+		free(itr->second.writeData);
+	}
+
+	if (m_sqes != NULL)
+	{
+		munmap(m_sqes, m_nSQEsSize);
+	}
+
+	if (m_cqRing != NULL)
+	{
+		munmap(m_cqRing, m_nCQRingSize);
+	}
+
+	if (m_sqRing != NULL)
+	{
+		munmap(m_sqRing, m_nSQRingSize);
+	}
+
+	if (m_ringFD >= 0)
+	{
+		close(m_ringFD);
+	}
+
+	pthread_mutex_destroy(&m_lock);
+}
+
+const char *UringBackend::getName()
+{
+	return "io_uring";
+}
+
+/**
+ * Sets up the submission and completion queues.
+ * Returns -1 if io_uring cannot be used here. Returns 0 if success.
+ */
+int UringBackend::init()
+{
+#ifdef USE_IO_URING
+	struct io_uring_params params;
+
+	memset(&params, 0, sizeof(params));
+	m_ringFD = syscall(__NR_io_uring_setup, QUEUE_SIZE, &params);
+
+	if (m_ringFD < 0)
+	{
+		Logger::getInstance()->info("io_uring is not available.");
+		return -1;
+	}
+
+	//Without internal polling, reads on an idle master would fail instead of waiting.
+	if ((params.features & IORING_FEAT_FAST_POLL) == 0)
+	{
+		Logger::getInstance()->info("io_uring cannot poll pseudo terminals.");
+		return -1;
+	}
+
+	m_nSQRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	m_nCQRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	m_nSQEsSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	m_sqRing = mmap(NULL, m_nSQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFD, IORING_OFF_SQ_RING);
+	m_cqRing = mmap(NULL, m_nCQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFD, IORING_OFF_CQ_RING);
+	m_sqes = mmap(NULL, m_nSQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFD, IORING_OFF_SQES);
+
+	if (m_sqRing == MAP_FAILED || m_cqRing == MAP_FAILED || m_sqes == MAP_FAILED)
+	{
+		m_sqRing = (m_sqRing == MAP_FAILED) ? NULL : m_sqRing;
+		m_cqRing = (m_cqRing == MAP_FAILED) ? NULL : m_cqRing;
+		m_sqes = (m_sqes == MAP_FAILED) ? NULL : m_sqes;
+
+		Logger::getInstance()->error("Cannot map io_uring queues.");
+		return -1;
+	}
+
+	m_sqHead = (unsigned int *)((char *)m_sqRing + params.sq_off.head);
+	m_sqTail = (unsigned int *)((char *)m_sqRing + params.sq_off.tail);
+	m_sqArray = (unsigned int *)((char *)m_sqRing + params.sq_off.array);
+	m_nSQMask = *(unsigned int *)((char *)m_sqRing + params.sq_off.ring_mask);
+	m_nSQEntries = params.sq_entries;
+	m_cqHead = (unsigned int *)((char *)m_cqRing + params.cq_off.head);
+	m_cqTail = (unsigned int *)((char *)m_cqRing + params.cq_off.tail);
+	m_cqes = (char *)m_cqRing + params.cq_off.cqes;
+	m_nCQMask = *(unsigned int *)((char *)m_cqRing + params.cq_off.ring_mask);
+
+	return createWakeEvent();
+#else
+	return -1;
+#endif
+}
+
+/**
+ * Changes the events wanted on a master. The operations are submitted by the reader thread,
+ * which is woken up if this is called from another thread.
+ * Returns 0 if success.
+ */
+int UringBackend::setEvents(Terminal *terminal, int nEvents)
+{
+	bool bWake;
+
+	pthread_mutex_lock(&m_lock);
+
+	UBTerminal_t &state = m_terminals[terminal];
+
+	state.nEvents = nEvents;
+
+	if (!state.bDirty)
+	{
+		state.bDirty = true;
+		m_dirtyTerminals.push_back(terminal);
+	}
+
+	bWake = (!m_bRunning || !pthread_equal(m_thread, pthread_self()));
+
+	pthread_mutex_unlock(&m_lock);
+
+	if (bWake)
+	{
+		wake();
+	}
+
+	return 0;
+}
+
+/**
+ * Checks whether the kernel may still be using the memory of the terminal.
+ */
+bool UringBackend::isBusy(Terminal *terminal)
+{
+	bool bBusy = false;
+
+	pthread_mutex_lock(&m_lock);
+
+	std::map<Terminal *, UBTerminal_t>::iterator itr = m_terminals.find(terminal);
+
+	if (itr != m_terminals.end())
+	{
+		bBusy = (itr->second.bReadArmed || itr->second.bWriteArmed || itr->second.bExitArmed);
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	return bBusy;
+}
+
+/**
+ * Gets the next free submission queue entry, submitting the queue first if it is full.
+ * Returns NULL if the queue is still full.
+ */
+void *UringBackend::getSQE()
+{
+#ifdef USE_IO_URING
+	unsigned int nTail = *m_sqTail;
+
+	__sync_synchronize();
+
+	if ((nTail - *m_sqHead) >= m_nSQEntries)
+	{
+		submit(0);
+
+		__sync_synchronize();
+
+		if ((nTail - *m_sqHead) >= m_nSQEntries)
+		{
+			return NULL;
+		}
+	}
+
+	m_sqArray[nTail & m_nSQMask] = (nTail & m_nSQMask);
+
+	return &((struct io_uring_sqe *)m_sqes)[nTail & m_nSQMask];
+#else
+	return NULL;
+#endif
+}
+
+/**
+ * Queues an operation, with the flags it takes, such as the events of a poll. It is submitted
+ * with the next wait for completions.
+ * Returns 0 if success.
+ */
+int UringBackend::queueOp(int nOpcode, int nFD, const void *addr, unsigned int nLength, uint64_t userData, unsigned int nFlags)
+{
+#ifdef USE_IO_URING
+	struct io_uring_sqe *sqe = (struct io_uring_sqe *)getSQE();
+
+	if (sqe == NULL)
+	{
+		Logger::getInstance()->error("Cannot queue pseudo terminal I/O.");
+		return -1;
+	}
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = nOpcode;
+	sqe->fd = nFD;
+	sqe->addr = (uintptr_t)addr;
+	sqe->len = nLength;
+	sqe->rw_flags = nFlags;
+	sqe->user_data = userData;
+
+	//The entry must be complete before the kernel can see it.
+	__sync_synchronize();
+	*m_sqTail = *m_sqTail + 1;
+	m_nToSubmit++;
+
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * Submits the queued operations, and waits until at least the given number of them completed.
+ * Returns -1 if an error occurs, with errno set. Returns 0 if success.
+ */
+int UringBackend::submit(unsigned int nMinComplete)
+{
+#ifdef USE_IO_URING
+	int result = syscall(__NR_io_uring_enter, m_ringFD, m_nToSubmit, nMinComplete,
+		(nMinComplete > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+
+	if (result < 0)
+	{
+		return -1;
+	}
+
+	m_nToSubmit -= result;
+
+	return 0;
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+/**
+ * Reads the wake up event, which completes when another thread wakes the reader.
+ */
+void UringBackend::armWake()
+{
+#ifdef USE_IO_URING
+	queueOp(IORING_OP_READ, m_wakeFD, &m_wakeValue, sizeof(m_wakeValue), UB_OP_WAKE);
+#endif
+}
+
+/**
+ * Submits the operations of the terminals whose events changed.
+ */
+void UringBackend::armTerminals()
+{
+	std::vector<Terminal *> terminals;
+
+	pthread_mutex_lock(&m_lock);
+	terminals.swap(m_dirtyTerminals);
+	pthread_mutex_unlock(&m_lock);
+
+	for (size_t i = 0; i < terminals.size(); i++)
+	{
+		armTerminal(terminals[i]);
+	}
+}
+
+/**
+ * Starts a read or write on the master if one is wanted and not already in flight, or
+ * cancels what is in flight once nothing is wanted anymore. The lock is not held while
+ * calling into the terminal, which takes its own locks and may change its events.
+ */
+void UringBackend::armTerminal(Terminal *terminal)
+{
+#ifdef USE_IO_URING
+	std::map<Terminal *, UBTerminal_t>::iterator itr;
+	uint64_t userData = (uintptr_t)terminal;
+	bool bRead;
+	bool bWrite;
+	bool bExit;
+	bool bCancel;
+	int nNumVectors;
+	size_t nSize;
+
+	pthread_mutex_lock(&m_lock);
+
+	itr = m_terminals.find(terminal);
+
+	if (itr == m_terminals.end())
+	{
+		pthread_mutex_unlock(&m_lock);
+		return;
+	}
+
+	//Entries are only erased by this thread, so the reference stays valid without the lock.
+	UBTerminal_t &state = itr->second;
+
+	state.bDirty = false;
+
+	if (state.nEvents == 0 && !state.bReadArmed && !state.bWriteArmed && !state.bExitArmed)
+	{
+		free(state.writeData);
+		m_terminals.erase(itr);
+		pthread_mutex_unlock(&m_lock);
+		return;
+	}
+
+	bRead = ((state.nEvents & PB_READ) != 0 && !state.bReadArmed);
+	bWrite = ((state.nEvents & PB_WRITE) != 0 && !state.bWriteArmed);
+	bExit = ((state.nEvents & PB_EXIT) != 0 && !state.bExitArmed);
+	bCancel = (state.nEvents == 0 && !state.bCancelled);
+
+	if (bCancel)
+	{
+		state.bCancelled = true;
+	}
+	else if (state.nEvents != 0)
+	{
+		state.bCancelled = false;
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	if (bCancel)
+	{
+		if (state.bReadArmed)
+		{
+			queueOp(IORING_OP_ASYNC_CANCEL, -1, (const void *)(uintptr_t)(userData | UB_OP_READ), 0, UB_OP_CANCEL);
+		}
+
+		if (state.bWriteArmed)
+		{
+			queueOp(IORING_OP_ASYNC_CANCEL, -1, (const void *)(uintptr_t)(userData | UB_OP_WRITE), 0, UB_OP_CANCEL);
+		}
+
+		if (state.bExitArmed)
+		{
+			queueOp(IORING_OP_ASYNC_CANCEL, -1, (const void *)(uintptr_t)(userData | UB_OP_EXIT), 0, UB_OP_CANCEL);
+		}
+
+		return;
+	}
+
+	if ((!bRead && !bWrite && !bExit) || !m_manager->beginIO(terminal))
+	{
+		return;
+	}
+
+	if (bExit && queueOp(IORING_OP_POLL_ADD, terminal->m_pidFD, NULL, 0, userData | UB_OP_EXIT, POLLIN) == 0)
+	{
+		pthread_mutex_lock(&m_lock);
+		state.bExitArmed = true;
+		pthread_mutex_unlock(&m_lock);
+	}
+
+	if (bRead)
+	{
+		nNumVectors = terminal->prepareRead(state.readVectors);
+
+		if (nNumVectors > 0 && queueOp(IORING_OP_READV, terminal->m_masterFD, state.readVectors, nNumVectors, userData | UB_OP_READ) == 0)
+		{
+			pthread_mutex_lock(&m_lock);
+			state.bReadArmed = true;
+			pthread_mutex_unlock(&m_lock);
+		}
+	}
+
+	if (bWrite)
+	{
+		if (state.writeData == NULL)
+		{
+			state.writeData = (char *)malloc(WRITE_SIZE);
+		}
+
+		nSize = (state.writeData != NULL) ? terminal->prepareWrite(state.writeData, WRITE_SIZE) : 0;
+
+		if (nSize > 0)
+		{
+			if (queueOp(IORING_OP_WRITE, terminal->m_masterFD, state.writeData, nSize, userData | UB_OP_WRITE) == 0)
+			{
+				pthread_mutex_lock(&m_lock);
+				state.bWriteArmed = true;
+				pthread_mutex_unlock(&m_lock);
+			}
+			else
+			{
+				//Nothing was written; the input stays queued.
+				terminal->completeWrite(0);
+			}
+		}
+	}
+
+	m_manager->endIO();
+#endif
+}
+
+/**
+ * Handles every completion posted so far.
+ */
+void UringBackend::reapCompletions()
+{
+#ifdef USE_IO_URING
+	unsigned int nHead = *m_cqHead;
+
+	while (true)
+	{
+		//The entry is only valid once its tail is seen.
+		__sync_synchronize();
+
+		if (nHead == *m_cqTail)
+		{
+			break;
+		}
+
+		struct io_uring_cqe *cqe = &((struct io_uring_cqe *)m_cqes)[nHead & m_nCQMask];
+		uint64_t userData = cqe->user_data;
+		int nResult = cqe->res;
+
+		//Hand the entry back to the kernel before doing anything that may take long.
+		nHead++;
+		__sync_synchronize();
+		*m_cqHead = nHead;
+
+		handleCompletion(userData, nResult);
+	}
+#endif
+}
+
+void UringBackend::handleCompletion(uint64_t userData, int nResult)
+{
+	Terminal *terminal = (Terminal *)(uintptr_t)(userData & ~(uint64_t)UB_OP_MASK);
+	int nOp = (int)(userData & UB_OP_MASK);
+
+	if (nOp == UB_OP_WAKE)
+	{
+		m_manager->handleWake();
+		armWake();
+		return;
+	}
+	else if (nOp == UB_OP_CANCEL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&m_lock);
+
+	std::map<Terminal *, UBTerminal_t>::iterator itr = m_terminals.find(terminal);
+
+	if (itr != m_terminals.end())
+	{
+		if (nOp == UB_OP_READ)
+		{
+			itr->second.bReadArmed = false;
+		}
+		else if (nOp == UB_OP_EXIT)
+		{
+			itr->second.bExitArmed = false;
+		}
+		else
+		{
+			itr->second.bWriteArmed = false;
+		}
+
+		if (!itr->second.bDirty)
+		{
+			itr->second.bDirty = true;
+			m_dirtyTerminals.push_back(terminal);
+		}
+	}
+
+	pthread_mutex_unlock(&m_lock);
+
+	m_manager->handleCompletion(terminal, (nOp == UB_OP_READ) ? PB_READ : ((nOp == UB_OP_EXIT) ? PB_EXIT : PB_WRITE), nResult);
+}
+
+/**
+ * Submits the operations of every terminal that needs them and waits for completions,
+ * all in one system call per round.
+ */
+int UringBackend::run()
+{
+	int result = 0;
+
+	pthread_mutex_lock(&m_lock);
+	m_thread = pthread_self();
+	m_bRunning = true;
+	pthread_mutex_unlock(&m_lock);
+
+	armWake();
+
+	while (!m_manager->isDone())
+	{
+		armTerminals();
+
+		if (submit(1) != 0)
+		{
+			if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				Logger::getInstance()->error("Cannot wait for pseudo terminals.");
+				result = -1;
+				break;
+			}
+		}
+
+		reapCompletions();
+	}
+
+	pthread_mutex_lock(&m_lock);
+	m_bRunning = false;
+	pthread_mutex_unlock(&m_lock);
+
+	return result;
+}
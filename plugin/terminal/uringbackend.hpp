@@ -0,0 +1,118 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef URINGBACKEND_HPP__
+#define URINGBACKEND_HPP__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <map>
+#include <vector>
+
+#include "ptybackend.hpp"
+
+/**
+ * Operations are told apart by the low bits of the terminal pointer in their user data,
+ * which are free since terminals are allocated at least 8 byte aligned.
+ */
+typedef enum
+{
+	UB_OP_WAKE = 0,
+	UB_OP_READ = 1,
+	UB_OP_WRITE = 2,
+	UB_OP_CANCEL = 3,
+	UB_OP_EXIT = 4, //Poll on the pidfd of the child.
+	UB_OP_MASK = 7
+} UBOp_t;
+
+/**
+ * I/O in flight on one master.
+ */
+typedef struct
+{
+	int nEvents; //Events wanted.
+	bool bDirty; //Events changed since the operations were last submitted.
+	bool bReadArmed;
+	bool bWriteArmed;
+	bool bExitArmed;
+	bool bCancelled;
+	struct iovec readVectors[2]; //Free space of the read ring the kernel is reading into.
+	char *writeData; //Copy of the input the kernel is writing, since the write queue may be resized meanwhile.
+} UBTerminal_t;
+
+/**
+ * Reads and writes the masters with io_uring. Reads go straight into the read ring of
+ * each terminal, and all submissions and completions of a round share one system call,
+ * however many sessions there are. The children are waited for by polling their pidfds
+ * in the same ring. Only available when built with USE_IO_URING, on kernels
+ * that poll pseudo terminals internally; otherwise init() fails and epoll is used instead.
+ */
+class UringBackend : public PTYBackend
+{
+private:
+	static const unsigned int QUEUE_SIZE;
+	static const size_t WRITE_SIZE;
+
+	int m_ringFD;
+	void *m_sqRing;
+	size_t m_nSQRingSize;
+	void *m_cqRing;
+	size_t m_nCQRingSize;
+	void *m_sqes;
+	size_t m_nSQEsSize;
+	volatile unsigned int *m_sqHead;
+	volatile unsigned int *m_sqTail;
+	unsigned int *m_sqArray;
+	unsigned int m_nSQMask;
+	unsigned int m_nSQEntries;
+	volatile unsigned int *m_cqHead;
+	volatile unsigned int *m_cqTail;
+	void *m_cqes;
+	unsigned int m_nCQMask;
+	unsigned int m_nToSubmit;
+	uint64_t m_wakeValue;
+	pthread_t m_thread;
+	bool m_bRunning;
+
+	std::map<Terminal *, UBTerminal_t> m_terminals;
+	std::vector<Terminal *> m_dirtyTerminals;
+	pthread_mutex_t m_lock; //Mutex lock for the terminal states.
+
+	void *getSQE();
+	int submit(unsigned int nMinComplete);
+	int queueOp(int nOpcode, int nFD, const void *addr, unsigned int nLength, uint64_t userData, unsigned int nFlags = 0);
+	void armWake();
+	void armTerminals();
+	void armTerminal(Terminal *terminal);
+	void reapCompletions();
+	void handleCompletion(uint64_t userData, int nResult);
+
+public:
+	UringBackend(SessionManager *manager);
+	~UringBackend();
+
+	const char *getName();
+	int init();
+	int setEvents(Terminal *terminal, int nEvents);
+	bool isBusy(Terminal *terminal);
+	int run();
+};
+
+#endif
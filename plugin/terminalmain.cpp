@@ -1,63 +1,217 @@
-/**
- * This file is part of SDLTerminal.
- * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
- *
- * SDLTerminal is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * SDLTerminal is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
-
- * You should have received a copy of the GNU General Public License
- * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "sdl/sdlterminal.hpp"
-#include "terminal/terminal.hpp"
-#include "terminal/vtterminalstate.hpp"
-#include "util/logger.hpp"
-
-int main()
-{
-	SDLTerminal *sdlTerminal = new SDLTerminal();
-	Terminal *terminal = new Terminal();
-
-	sdlTerminal->start();
-
-	if (sdlTerminal->isReady())
-	{
-		//Must set window size before starting the terminal.
-		terminal->setWindowSize(sdlTerminal->getMaximumColumnsOfText(), sdlTerminal->getMaximumLinesOfText());
-
-		if (terminal->start() == 0) //Non-blocking, creates a thread to read and a child process for slave device.
-		{
-			//Enable autowrap
-			sdlTerminal->getTerminalState()->addTerminalModeFlags(TS_TM_AUTO_WRAP);
-
-			sdlTerminal->setExtTerminal(terminal);
-			terminal->setExtTerminal(sdlTerminal);
-
-			sdlTerminal->run(); //Blocking.
-		}
-		else
-		{
-			Logger::getInstance()->fatal("TTY Terminal not started.");
-		}
-	}
-	else
-	{
-		Logger::getInstance()->fatal("SDLTerminal not started.");
-	}
-
-	sdlTerminal->setExtTerminal(NULL);
-	terminal->setExtTerminal(NULL);
-
-	delete terminal;
-	delete sdlTerminal;
-
-	exit(0);
-}
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sdl/sdlterminal.hpp"
+#include "terminal/session.hpp"
+#include "terminal/sessionclient.hpp"
+#include "terminal/sessionmanager.hpp"
+#include "util/logger.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Starts recording the session if the configuration asks for it.
+ */
+static void startRecording(Session *session, ConfigManager *config)
+{
+	const char *sFileName = config->getValue("Session", "record");
+	const char *sFormat = config->getValue("Session", "recordformat");
+
+	if (sFileName != NULL && sFileName[0] != '\0')
+	{
+		SRFormat_t format = SR_FORMAT_BINARY;
+
+		if (sFormat != NULL && strcmp(sFormat, "asciicast") == 0)
+		{
+			format = SR_FORMAT_ASCIICAST;
+		}
+		else if (sFormat != NULL && strcmp(sFormat, "raw") == 0)
+		{
+			format = SR_FORMAT_RAW;
+		}
+
+		session->startRecording(sFileName, format);
+	}
+}
+
+/**
+ * Has the session send XOFF to the child when the output comes in faster than it is shown,
+ * if the configuration asks for it.
+ */
+static void setFlowControl(Session *session, ConfigManager *config)
+{
+	const char *sFlowControl = config->getValue("Session", "flowcontrol");
+
+	session->getTerminal()->setXOffEnabled(sFlowControl != NULL && strcmp(sFlowControl, "xoff") == 0);
+}
+
+/**
+ * Splits the command of the configuration into a NULL terminated list of arguments,
+ * separated by blanks.
+ * Returns NULL if there is no command, so that the session logs in.
+ */
+static char **getCommand(ConfigManager *config)
+{
+	const char *sCommand = config->getValue("Session", "command");
+	char **command;
+	char *sWords;
+	char *sSave;
+	int nNumWords = 0;
+
+	if (sCommand == NULL)
+	{
+		return NULL;
+	}
+
+	sWords = strdup(sCommand);
+	command = (char **)malloc((strlen(sCommand) / 2 + 2) * sizeof(char *));
+
+	for (char *sWord = strtok_r(sWords, " \t", &sSave); sWord != NULL; sWord = strtok_r(NULL, " \t", &sSave))
+	{
+		command[nNumWords++] = strdup(sWord);
+	}
+
+	command[nNumWords] = NULL;
+	free(sWords);
+
+	if (nNumWords == 0)
+	{
+		free(command);
+		return NULL;
+	}
+
+	return command;
+}
+
+static void freeCommand(char **command)
+{
+	if (command != NULL)
+	{
+		for (int i = 0; command[i] != NULL; i++)
+		{
+			free(command[i]);
+		}
+
+		free(command);
+	}
+}
+
+/**
+ * Attaches to a session of the daemon if the configuration names one. Attaching to a
+ * session that does not exist starts a new one.
+ * Returns NULL if there is no daemon to attach to.
+ */
+static SessionClient *attachDaemon(SDLTerminal *sdlTerminal)
+{
+	ConfigManager *config = sdlTerminal->getConfig();
+	const char *sPath = config->getValue("Session", "daemon");
+	const char *sSession = config->getValue("Session", "daemonsession");
+	int nSession = (sSession != NULL && sSession[0] != '\0') ? atoi(sSession) : 0;
+	int nWidth = sdlTerminal->getMaximumColumnsOfText();
+	int nHeight = sdlTerminal->getMaximumLinesOfText();
+	SessionClient *client;
+
+	if (sPath == NULL || sPath[0] == '\0')
+	{
+		return NULL;
+	}
+
+	client = new SessionClient();
+
+	if (client->connect(sPath) != 0)
+	{
+		Logger::getInstance()->error("Cannot connect to daemon. Running the session here.");
+		delete client;
+		return NULL;
+	}
+
+	if (client->attach(nSession, nWidth, nHeight) != 0)
+	{
+		//Only one attach per connection.
+		delete client;
+		client = new SessionClient();
+
+		if (nSession < 0 || client->connect(sPath) != 0 || client->attach(-1, nWidth, nHeight) != 0)
+		{
+			Logger::getInstance()->error("Cannot attach to daemon. Running the session here.");
+			delete client;
+			return NULL;
+		}
+	}
+
+	return client;
+}
+
+int main()
+{
+	SDLTerminal *sdlTerminal = new SDLTerminal();
+	SessionManager *manager = new SessionManager();
+	SessionClient *client = NULL;
+	char **command = NULL;
+
+	sdlTerminal->start();
+
+	if (sdlTerminal->isReady())
+	{
+		command = getCommand(sdlTerminal->getConfig());
+		manager->setCommand(command);
+		client = attachDaemon(sdlTerminal);
+
+		if (client != NULL)
+		{
+			//Closing the terminal detaches, and the session keeps running in the daemon.
+			sdlTerminal->showClient(client);
+			sdlTerminal->run(); //Blocking.
+		}
+		else if (manager->start() == 0) //Non-blocking, creates the threads that read and parse every session.
+		{
+			//Creates a child process for the slave device, sized to the screen.
+			Session *session = manager->createSession(sdlTerminal->getMaximumColumnsOfText(), sdlTerminal->getMaximumLinesOfText());
+
+			if (session != NULL)
+			{
+				startRecording(session, sdlTerminal->getConfig());
+				setFlowControl(session, sdlTerminal->getConfig());
+				sdlTerminal->showSession(session);
+				sdlTerminal->run(); //Blocking.
+			}
+			else
+			{
+				Logger::getInstance()->fatal("TTY Terminal not started.");
+			}
+		}
+		else
+		{
+			Logger::getInstance()->fatal("Session manager not started.");
+		}
+	}
+	else
+	{
+		Logger::getInstance()->fatal("SDLTerminal not started.");
+	}
+
+	sdlTerminal->showSession(NULL);
+
+	delete client;
+	delete manager;
+	delete sdlTerminal;
+	freeCommand(command);
+
+	exit(0);
+}
@@ -0,0 +1,197 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+
+#include "terminal/sessionmanager.hpp"
+#include "terminal/terminal.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <vector>
+
+/**
+ * Counts the output of a terminal without parsing it, so that the I/O dominates.
+ */
+class CountingTerminal : public ExtTerminal
+{
+private:
+	char m_tail[16];
+	size_t m_nTailSize;
+
+public:
+	volatile size_t m_nBytes;
+	volatile bool m_bDone;
+
+	CountingTerminal()
+	{
+		m_nTailSize = 0;
+		m_nBytes = 0;
+		m_bDone = false;
+		setReady(true);
+	}
+
+	void insertData(const char *data, size_t size)
+	{
+		char buffer[sizeof(m_tail) * 2];
+		size_t nSize = (size < sizeof(m_tail)) ? size : sizeof(m_tail);
+
+		m_nBytes += size;
+
+		//Look for the marker in the last bytes seen, in case it spans two calls.
+		memcpy(buffer, m_tail, m_nTailSize);
+		memcpy(buffer + m_nTailSize, data + size - nSize, nSize);
+		nSize += m_nTailSize;
+
+		if (memmem(buffer, nSize, "BENCHDONE", 9) != NULL)
+		{
+			m_bDone = true;
+		}
+
+		m_nTailSize = (nSize < sizeof(m_tail)) ? nSize : sizeof(m_tail);
+		memcpy(m_tail, buffer + nSize - m_nTailSize, m_nTailSize);
+	}
+};
+
+double getTime()
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+
+	return now.tv_sec + (now.tv_usec / 1000000.0);
+}
+
+/**
+ * Has every session write the given amount of output at the same time, and reports how
+ * long the backend took to read all of it and how much CPU the reader and parser used.
+ */
+void benchBackend(PBBackend_t type, int nNumSessions, int nMegabytes)
+{
+	SessionManager *manager = new SessionManager();
+	std::vector<Terminal *> terminals;
+	std::vector<CountingTerminal *> counters;
+	struct rusage start;
+	struct rusage end;
+	char command[256];
+	bool bDone = false;
+	double startTime;
+	double elapsed;
+	double cpu;
+	size_t nBytes = 0;
+
+	if (manager->start(type) != 0)
+	{
+		printf("%s: not available\n", (type == PB_BACKEND_URING) ? "io_uring" : "epoll");
+		delete manager;
+		return;
+	}
+
+	for (int i = 0; i < nNumSessions; i++)
+	{
+		Terminal *terminal = new Terminal();
+		CountingTerminal *counter = new CountingTerminal();
+
+		terminal->setExtTerminal(counter);
+		terminal->setWindowSize(80, 24);
+
+		if (terminal->start() != 0 || manager->addTerminal(terminal) != 0)
+		{
+			printf("Cannot start session %d\n", i);
+		}
+
+		terminal->insertData("stty -echo\n", 11);
+		terminals.push_back(terminal);
+		counters.push_back(counter);
+	}
+
+	//Let the shells settle before counting.
+	sleep(1);
+
+	for (int i = 0; i < nNumSessions; i++)
+	{
+		counters[i]->m_nBytes = 0;
+	}
+
+	snprintf(command, sizeof(command), "yes | head -c %d; echo BENCH\"\"DONE\n", nMegabytes * 1024 * 1024);
+
+	getrusage(RUSAGE_SELF, &start);
+	startTime = getTime();
+
+	for (int i = 0; i < nNumSessions; i++)
+	{
+		terminals[i]->insertData(command, strlen(command));
+	}
+
+	while (!bDone && (getTime() - startTime) < 120)
+	{
+		usleep(1000);
+		bDone = true;
+
+		for (int i = 0; i < nNumSessions; i++)
+		{
+			bDone = bDone && counters[i]->m_bDone;
+		}
+	}
+
+	elapsed = getTime() - startTime;
+	getrusage(RUSAGE_SELF, &end);
+
+	cpu = (end.ru_utime.tv_sec - start.ru_utime.tv_sec) + (end.ru_utime.tv_usec - start.ru_utime.tv_usec) / 1000000.0
+		+ (end.ru_stime.tv_sec - start.ru_stime.tv_sec) + (end.ru_stime.tv_usec - start.ru_stime.tv_usec) / 1000000.0;
+
+	for (int i = 0; i < nNumSessions; i++)
+	{
+		nBytes += counters[i]->m_nBytes;
+	}
+
+	printf("%-8s %3d sessions %7.1f MB %s in %6.3fs %8.1f MB/s cpu %6.3fs switches %ld\n",
+		manager->getBackend()->getName(), nNumSessions, nBytes / (1024.0 * 1024.0), bDone ? "done" : "TIMED OUT",
+		elapsed, nBytes / (1024.0 * 1024.0) / elapsed, cpu,
+		(end.ru_nvcsw - start.ru_nvcsw) + (end.ru_nivcsw - start.ru_nivcsw));
+
+	for (int i = 0; i < nNumSessions; i++)
+	{
+		delete terminals[i];
+		delete counters[i];
+	}
+
+	delete manager;
+}
+
+/**
+ * Compares the epoll and io_uring backends.
+ * Usage: benchbackend [sessions] [megabytes per session]
+ */
+int main(int argc, char **argv)
+{
+	int nNumSessions = (argc > 1) ? atoi(argv[1]) : 4;
+	int nMegabytes = (argc > 2) ? atoi(argv[2]) : 16;
+
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	benchBackend(PB_BACKEND_EPOLL, nNumSessions, nMegabytes);
+	benchBackend(PB_BACKEND_URING, nNumSessions, nMegabytes);
+
+	return 0;
+}
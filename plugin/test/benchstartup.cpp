@@ -0,0 +1,177 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+
+#include "terminal/sessionmanager.hpp"
+#include "terminal/terminal.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Notes when the first output of the terminal arrives.
+ */
+class FirstOutputTerminal : public ExtTerminal
+{
+public:
+	volatile double m_firstOutputTime;
+
+	FirstOutputTerminal()
+	{
+		m_firstOutputTime = 0;
+		setReady(true);
+	}
+
+	void insertData(const char *data, size_t size);
+};
+
+double getTime()
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+
+	return now.tv_sec + (now.tv_usec / 1000000.0);
+}
+
+void FirstOutputTerminal::insertData(const char *data, size_t size)
+{
+	if (m_firstOutputTime == 0 && size > 0)
+	{
+		m_firstOutputTime = getTime();
+	}
+}
+
+void printTimes(const char *sName, std::vector<double> &times)
+{
+	double total = 0;
+
+	std::sort(times.begin(), times.end());
+
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		total += times[i];
+	}
+
+	printf("%-14s avg %7.3fms median %7.3fms max %7.3fms\n", sName, total * 1000 / times.size(),
+		times[times.size() / 2] * 1000, times.back() * 1000);
+}
+
+/**
+ * Starts terminals one after another, and reports how long starting each took, and how long
+ * until its first output was read.
+ */
+void benchStartup(int nNumTerminals, const char *const *command)
+{
+	SessionManager *manager = new SessionManager();
+	std::vector<double> startTimes;
+	std::vector<double> outputTimes;
+
+	if (manager->start() != 0)
+	{
+		printf("Cannot start session manager\n");
+		delete manager;
+		return;
+	}
+
+	for (int i = 0; i < nNumTerminals; i++)
+	{
+		Terminal *terminal = new Terminal();
+		FirstOutputTerminal *output = new FirstOutputTerminal();
+		double startTime = getTime();
+
+		terminal->setExtTerminal(output);
+		terminal->setWindowSize(80, 24);
+		terminal->setCommand(command);
+
+		if (terminal->start() != 0 || manager->addTerminal(terminal) != 0)
+		{
+			printf("Cannot start terminal %d\n", i);
+		}
+		else
+		{
+			startTimes.push_back(getTime() - startTime);
+
+			while (output->m_firstOutputTime == 0 && (getTime() - startTime) < 10)
+			{
+				usleep(100);
+			}
+
+			outputTimes.push_back(output->m_firstOutputTime - startTime);
+		}
+
+		while (!terminal->isDone() && (getTime() - startTime) < 10)
+		{
+			usleep(1000);
+		}
+
+		delete terminal;
+		delete output;
+	}
+
+	if (!startTimes.empty())
+	{
+		printf("%d terminals running '%s', descriptor limit %ld\n", (int)startTimes.size(), command[0], sysconf(_SC_OPEN_MAX));
+		printTimes("start", startTimes);
+		printTimes("first output", outputTimes);
+	}
+
+	delete manager;
+}
+
+/**
+ * Measures how long opening a terminal takes. The descriptor limit is raised as far as
+ * allowed, which made closing every possible descriptor in the child slow.
+ * Usage: benchstartup [terminals] [command [args...]]
+ */
+int main(int argc, char **argv)
+{
+	int nNumTerminals = (argc > 1) ? atoi(argv[1]) : 50;
+	const char *defaultCommand[] = { "/bin/echo", "ready", NULL };
+	std::vector<const char *> command;
+	struct rlimit limit;
+
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	if (argc > 2)
+	{
+		command.assign(argv + 2, argv + argc);
+		command.push_back(NULL);
+	}
+	else
+	{
+		command.assign(defaultCommand, defaultCommand + 3);
+	}
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	benchStartup(nNumTerminals, &command[0]);
+
+	return 0;
+}
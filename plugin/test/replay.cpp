@@ -0,0 +1,266 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+
+#include "terminal/recordingplayer.hpp"
+#include "terminal/recordingreader.hpp"
+#include "terminal/vtterminalstate.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <vector>
+
+static const int DEFAULT_WIDTH = 80;
+static const int DEFAULT_HEIGHT = 24;
+
+double getTime()
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+
+	return now.tv_sec + (now.tv_usec / 1000000.0);
+}
+
+/**
+ * Gets a hash of what is on the screen: the text and graphics state of every line, and
+ * the cursor. Equal digests mean two replays ended on the same screen.
+ */
+unsigned int getScreenDigest(VTTerminalState *state)
+{
+	TSLineGraphicsState_t *states[64];
+	int nNumStates;
+	int nTopLineIndex = state->getBufferTopLineIndex();
+	int nHeight = state->getDisplayScreenSize().getY();
+	Point cursor = state->getCursorLocation();
+	unsigned int nHash = 2166136261U;
+
+	for (int i = 0; i < nHeight; i++)
+	{
+		DataBuffer *line = state->getBufferLine(nTopLineIndex + i);
+
+		nHash = (nHash ^ ((line != NULL) ? line->hash() : 0)) * 16777619U;
+
+		state->getLineGraphicsState(i + 1, states, nNumStates, 64);
+
+		for (int j = 0; j < nNumStates && j < 64; j++)
+		{
+			nHash = (nHash ^ states[j]->nColumn) * 16777619U;
+			nHash = (nHash ^ states[j]->nGraphicsMode) * 16777619U;
+			nHash = (nHash ^ ((states[j]->foregroundColor << 8) | states[j]->backgroundColor)) * 16777619U;
+		}
+	}
+
+	nHash = (nHash ^ cursor.getX()) * 16777619U;
+	nHash = (nHash ^ cursor.getY()) * 16777619U;
+
+	return nHash;
+}
+
+/**
+ * Feeds every output record of the recording into a new terminal state, as fast as it
+ * can. Resize records resize the screen. Replies the state would send to the child are
+ * dropped.
+ * Returns the screen digest at the end.
+ */
+unsigned int replay(RecordingReader *reader, int nWidth, int nHeight, size_t &nBytes, int &nNumRecords, TSMemoryUsage_t &usage)
+{
+	VTTerminalState *state = new VTTerminalState();
+	ExtTerminal sink;
+	SRRecord_t type;
+	uint64_t nTime;
+	const char *data;
+	size_t size;
+	char sSize[32];
+	unsigned int nDigest;
+
+	state->setDisplayScreenSize(nWidth, nHeight);
+	state->addTerminalModeFlags(TS_TM_AUTO_WRAP);
+
+	nBytes = 0;
+	nNumRecords = 0;
+	reader->rewind();
+
+	while (reader->next(type, nTime, data, size) > 0)
+	{
+		if (type == SR_RECORD_OUTPUT)
+		{
+			state->insertString(data, size, &sink);
+			nBytes += size;
+		}
+		else if (type == SR_RECORD_RESIZE && size < sizeof(sSize))
+		{
+			memcpy(sSize, data, size);
+			sSize[size] = '\0';
+
+			if (sscanf(sSize, "%dx%d", &nWidth, &nHeight) == 2)
+			{
+				state->resizeDisplayScreen(nWidth, nHeight);
+			}
+		}
+
+		nNumRecords++;
+	}
+
+	nDigest = getScreenDigest(state);
+	state->getMemoryUsage(usage);
+	delete state;
+
+	return nDigest;
+}
+
+/**
+ * Seeks to the given times through the keyframes of the recording, and reports how long
+ * opening and each seek took.
+ * Returns the screen digest at the last time.
+ */
+unsigned int seek(const char *sFileName, int nWidth, int nHeight, std::vector<double> &times)
+{
+	RecordingPlayer player;
+	unsigned int nDigest = 0;
+	double startTime = getTime();
+
+	if (player.open(sFileName, nWidth, nHeight) != 0)
+	{
+		return 0;
+	}
+
+	printf("opened in %.3fs, %d keyframes, %.1fs long\n", getTime() - startTime, player.getNumKeyframes(), player.getDuration() / 1000000.0);
+
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		startTime = getTime();
+		player.seek((uint64_t)(times[i] * 1000000));
+		nDigest = getScreenDigest(player.getState());
+
+		printf("seek to %.3fs: %.3fs, replayed %.1f KB, digest %08x\n", times[i], getTime() - startTime,
+			player.getReplayedBytes() / 1024.0, nDigest);
+	}
+
+	return nDigest;
+}
+
+void printUsage()
+{
+	printf("Usage: replay [-s <width>x<height>] [-c <chunk size>] [-n <passes>] [-t <seconds>]... <recording>\n");
+	printf("Replays a binary, asciicast or raw recording into a terminal state without a display.\n");
+	printf("  -s  Screen size when the recording has none. Default %dx%d.\n", DEFAULT_WIDTH, DEFAULT_HEIGHT);
+	printf("  -c  Bytes fed at a time from a raw recording. Default 4096.\n");
+	printf("  -n  Number of times to replay. Default 1.\n");
+	printf("  -t  Seek to a time instead, using keyframes. Can be repeated.\n");
+}
+
+int main(int argc, char **argv)
+{
+	static const char *FORMAT_NAMES[] = { "binary", "asciicast", "raw" };
+	RecordingReader reader;
+	int nWidth = DEFAULT_WIDTH;
+	int nHeight = DEFAULT_HEIGHT;
+	int nNumPasses = 1;
+	unsigned int nDigest = 0;
+	bool bDigestChanged = false;
+	std::vector<double> times;
+	struct rusage usage;
+	int opt;
+
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	while ((opt = getopt(argc, argv, "s:c:n:t:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 's':
+			if (sscanf(optarg, "%dx%d", &nWidth, &nHeight) != 2 || nWidth < 1 || nHeight < 1)
+			{
+				printUsage();
+				return 1;
+			}
+			break;
+		case 'c':
+			reader.setChunkSize(atoi(optarg));
+			break;
+		case 'n':
+			nNumPasses = atoi(optarg);
+			break;
+		case 't':
+			times.push_back(atof(optarg));
+			break;
+		default:
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (optind >= argc || nNumPasses < 1)
+	{
+		printUsage();
+		return 1;
+	}
+
+	if (reader.open(argv[optind]) != 0)
+	{
+		printf("Cannot read %s\n", argv[optind]);
+		return 1;
+	}
+
+	if (reader.getWidth() > 0 && reader.getHeight() > 0)
+	{
+		nWidth = reader.getWidth();
+		nHeight = reader.getHeight();
+	}
+
+	printf("%s: %s, %dx%d, %.1f MB\n", argv[optind], FORMAT_NAMES[reader.getFormat()], nWidth, nHeight, reader.getSize() / (1024.0 * 1024.0));
+
+	if (!times.empty())
+	{
+		nNumPasses = 0;
+		nDigest = seek(argv[optind], nWidth, nHeight, times);
+	}
+
+	for (int i = 0; i < nNumPasses; i++)
+	{
+		TSMemoryUsage_t stateUsage;
+		size_t nBytes;
+		int nNumRecords;
+		double startTime = getTime();
+		unsigned int nPassDigest = replay(&reader, nWidth, nHeight, nBytes, nNumRecords, stateUsage);
+		double elapsed = getTime() - startTime;
+
+		printf("pass %d: %d records, %.1f MB of output in %.3fs, %.1f MB/s, state %lu KB with %d history lines\n",
+			i + 1, nNumRecords, nBytes / (1024.0 * 1024.0), elapsed, nBytes / (1024.0 * 1024.0) / elapsed,
+			(unsigned long)((stateUsage.nLineBytes + stateUsage.nSpareBytes + stateUsage.nOverheadBytes
+				+ stateUsage.nAttributeBytes + stateUsage.nIndexBytes) / 1024),
+			stateUsage.nHistoryLines);
+
+		bDigestChanged = bDigestChanged || (i > 0 && nPassDigest != nDigest);
+		nDigest = nPassDigest;
+	}
+
+	getrusage(RUSAGE_SELF, &usage);
+
+	printf("peak memory %ld KB\n", usage.ru_maxrss);
+	printf("screen digest %08x%s\n", nDigest, bDigestChanged ? " (changed between passes)" : "");
+
+	return bDigestChanged ? 1 : 0;
+}
@@ -0,0 +1,320 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+#include "test/unittest.hpp"
+
+#include "terminal/recordingplayer.hpp"
+#include "terminal/recordingreader.hpp"
+#include "terminal/sessionrecorder.hpp"
+#include "terminal/vtterminalstate.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * Records output split in awkward places, then reads it back and checks that the same
+ * output and resizes come out.
+ */
+void testRoundTrip(SRFormat_t format, const char *sName)
+{
+	SessionRecorder *recorder = new SessionRecorder();
+	RecordingReader reader;
+	const char *output = "plain \"quoted\" back\\slash\ttab\r\n\x1B[1mbold\x1B[0m \xC3\xA9t\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 \x01\x7F";
+	size_t nOutputSize = strlen(output);
+	std::string expected;
+	std::string actual;
+	std::string resize;
+	char sFileName[64];
+	char sMsg[128];
+	SRRecord_t type;
+	uint64_t nTime;
+	uint64_t nLastTime = 0;
+	const char *data;
+	size_t size;
+	bool bOrdered = true;
+
+	snprintf(sFileName, sizeof(sFileName), "/tmp/testrecording.%d", (int)getpid());
+
+	assertEquals(0, recorder->start(sFileName, format, 80, 24), "Test recording start");
+
+	//Split in the middle of the UTF-8 characters.
+	for (size_t i = 0; i < nOutputSize; i += 5)
+	{
+		size_t nSize = (nOutputSize - i < 5) ? (nOutputSize - i) : 5;
+
+		recorder->recordOutput(output + i, nSize);
+		expected.append(output + i, nSize);
+
+		if (i == 20)
+		{
+			recorder->recordResize(100, 30);
+			usleep(20000);
+		}
+	}
+
+	recorder->stop();
+	assertEquals(expected.size(), recorder->getRecordedBytes(), "Test recording recorded bytes");
+	assertEquals(0, recorder->getDroppedBytes(), "Test recording dropped bytes");
+	delete recorder;
+
+	snprintf(sMsg, sizeof(sMsg), "Test recording open %s", sName);
+	assertEquals(0, reader.open(sFileName), sMsg);
+	assertEquals(format, reader.getFormat(), "Test recording format");
+
+	while (reader.next(type, nTime, data, size) > 0)
+	{
+		if (type == SR_RECORD_OUTPUT)
+		{
+			actual.append(data, size);
+		}
+		else if (type == SR_RECORD_RESIZE)
+		{
+			resize.assign(data, size);
+		}
+
+		bOrdered = bOrdered && (nTime >= nLastTime);
+		nLastTime = nTime;
+	}
+
+	snprintf(sMsg, sizeof(sMsg), "Test recording output %s", sName);
+	assertEquals(expected.c_str(), expected.size(), actual.c_str(), actual.size(), sMsg);
+	assertEquals(1, bOrdered, "Test recording time order");
+
+	if (format != SR_FORMAT_RAW)
+	{
+		assertEquals(80, reader.getWidth(), "Test recording width");
+		assertEquals(24, reader.getHeight(), "Test recording height");
+		assertEquals("100x30", resize.c_str(), "Test recording resize");
+	}
+
+	reader.close();
+	unlink(sFileName);
+}
+
+void testAsciicast()
+{
+	RecordingReader reader;
+	char sFileName[64];
+	SRRecord_t type;
+	uint64_t nTime;
+	const char *data;
+	size_t size;
+	FILE *file;
+
+	snprintf(sFileName, sizeof(sFileName), "/tmp/testrecording.%d", (int)getpid());
+	file = fopen(sFileName, "w");
+	fprintf(file, "{\"version\": 2, \"width\": 132, \"height\": 43, \"env\": {\"TERM\": \"xterm\"}}\n");
+	fprintf(file, "[0.5, \"o\", \"a\\u00e9\\ud83d\\ude00\\/\"]\n\n");
+	fprintf(file, "not an event\n");
+	fprintf(file, "[ 1.25 , \"i\" , \"ls\\r\" ]\n");
+	fprintf(file, "[2, \"o\", \"end\"]");
+	fclose(file);
+
+	assertEquals(0, reader.open(sFileName), "Test asciicast open");
+	assertEquals(132, reader.getWidth(), "Test asciicast width");
+	assertEquals(43, reader.getHeight(), "Test asciicast height");
+
+	assertEquals(1, reader.next(type, nTime, data, size), "Test asciicast event");
+	assertEquals(SR_RECORD_OUTPUT, type, "Test asciicast event type");
+	assertEquals(500000, (int)nTime, "Test asciicast event time");
+	assertEquals("a\xC3\xA9\xF0\x9F\x98\x80/", 8, data, size, "Test asciicast event data");
+
+	assertEquals(1, reader.next(type, nTime, data, size), "Test asciicast skip invalid");
+	assertEquals('i', type, "Test asciicast input type");
+	assertEquals(1250000, (int)nTime, "Test asciicast input time");
+	assertEquals("ls\r", 3, data, size, "Test asciicast input data");
+
+	assertEquals(1, reader.next(type, nTime, data, size), "Test asciicast last event");
+	assertEquals("end", 3, data, size, "Test asciicast last event data");
+	assertEquals(0, reader.next(type, nTime, data, size), "Test asciicast end");
+
+	reader.close();
+	unlink(sFileName);
+}
+
+/**
+ * Replays the recording from the start up to the given time, without keyframes.
+ */
+VTTerminalState *replayTo(const char *sFileName, uint64_t nTime)
+{
+	RecordingReader reader;
+	VTTerminalState *state = new VTTerminalState();
+	SRRecord_t type;
+	uint64_t nRecordTime;
+	const char *data;
+	size_t size;
+
+	reader.open(sFileName);
+	state->setDisplayScreenSize(reader.getWidth(), reader.getHeight());
+	state->addTerminalModeFlags(TS_TM_AUTO_WRAP);
+
+	while (reader.next(type, nRecordTime, data, size) > 0 && nRecordTime <= nTime)
+	{
+		if (type == SR_RECORD_OUTPUT)
+		{
+			state->insertString(data, size, NULL);
+		}
+		else if (type == SR_RECORD_RESIZE)
+		{
+			state->resizeDisplayScreen(100, 30);
+		}
+	}
+
+	return state;
+}
+
+bool isSameScreen(VTTerminalState *state, VTTerminalState *expected)
+{
+	int nHeight = expected->getDisplayScreenSize().getY();
+
+	if (state->getDisplayScreenSize().getX() != expected->getDisplayScreenSize().getX()
+		|| state->getDisplayScreenSize().getY() != nHeight
+		|| state->getCursorLocation().getX() != expected->getCursorLocation().getX()
+		|| state->getCursorLocation().getY() != expected->getCursorLocation().getY())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < nHeight; i++)
+	{
+		DataBuffer *line = state->getBufferLine(state->getBufferTopLineIndex() + i);
+		DataBuffer *expectedLine = expected->getBufferLine(expected->getBufferTopLineIndex() + i);
+
+		if (!line->equals(expectedLine))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void testSeek()
+{
+	SessionRecorder *recorder = new SessionRecorder();
+	VTTerminalState *state = new VTTerminalState();
+	RecordingPlayer player;
+	RecordingReader reader;
+	std::vector<uint64_t> times;
+	char sFileName[64];
+	char sLine[64];
+	char sMsg[128];
+	SRRecord_t type;
+	uint64_t nTime;
+	const char *data;
+	size_t size;
+	int targets[] = { 85, 15, 55, 56, 0, 99 };
+
+	snprintf(sFileName, sizeof(sFileName), "/tmp/testrecording.%d", (int)getpid());
+
+	state->setDisplayScreenSize(80, 24);
+	state->addTerminalModeFlags(TS_TM_AUTO_WRAP);
+	assertEquals(0, recorder->start(sFileName, SR_FORMAT_BINARY, 80, 24), "Test seek recording start");
+
+	for (int i = 0; i < 100; i++)
+	{
+		snprintf(sLine, sizeof(sLine), "\x1B[3%dmline %d\x1B[0m\r\n%s", i % 8, i, (i % 7 == 0) ? "\x1B[5;10H" : "");
+		recorder->recordOutput(sLine, strlen(sLine));
+		state->insertString(sLine, NULL);
+
+		if (i == 60)
+		{
+			state->resizeDisplayScreen(100, 30);
+			recorder->recordResize(100, 30);
+		}
+
+		if (i % 25 == 24)
+		{
+			recorder->recordKeyframe(state);
+		}
+
+		//Output closer together than this is coalesced into one record.
+		usleep(12000);
+	}
+
+	recorder->stop();
+	delete recorder;
+	delete state;
+
+	reader.open(sFileName);
+	assertEquals(4, reader.getKeyframes().size(), "Test seek index");
+
+	while (reader.next(type, nTime, data, size) > 0)
+	{
+		if (type == SR_RECORD_OUTPUT)
+		{
+			times.push_back(nTime);
+		}
+	}
+
+	assertEquals(100, times.size(), "Test seek records");
+	assertEquals(0, player.open(sFileName, 0, 0), "Test seek open");
+	assertEquals(4, player.getNumKeyframes(), "Test seek keyframes");
+
+	for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++)
+	{
+		VTTerminalState *expected = replayTo(sFileName, times[targets[i]]);
+
+		snprintf(sMsg, sizeof(sMsg), "Test seek to record %d", targets[i]);
+		assertEquals(0, player.seek(times[targets[i]]), sMsg);
+		assertEquals(1, isSameScreen(player.getState(), expected), sMsg);
+
+		delete expected;
+	}
+
+	//Seeking forward past a keyframe starts from the keyframe.
+	player.seek(times[10]);
+	player.seek(times[80]);
+	assertEquals(1, player.getReplayedBytes() < 10 * 32, "Test seek replays from keyframe");
+
+	player.close();
+
+	//An index offset that wraps around when added to is ignored.
+	const unsigned char wrappedOffset[8] = { 0xF3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	FILE *file = fopen(sFileName, "r+b");
+
+	fseek(file, -(long)SessionRecorder::TRAILER_SIZE, SEEK_END);
+	fwrite(wrappedOffset, 1, sizeof(wrappedOffset), file);
+	fclose(file);
+
+	RecordingReader corrupted;
+
+	corrupted.open(sFileName);
+	assertEquals(0, corrupted.getKeyframes().size(), "Test seek wrapped index offset");
+	corrupted.close();
+
+	unlink(sFileName);
+}
+
+int main()
+{
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	testRoundTrip(SR_FORMAT_BINARY, "binary");
+	testRoundTrip(SR_FORMAT_ASCIICAST, "asciicast");
+	testRoundTrip(SR_FORMAT_RAW, "raw");
+	testAsciicast();
+	testSeek();
+
+	return 0;
+}
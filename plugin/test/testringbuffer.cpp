@@ -0,0 +1,96 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+#include "util/ringbuffer.hpp"
+#include "test/unittest.hpp"
+
+#include <string.h>
+
+void testWrap()
+{
+	RingBuffer *ring = new RingBuffer(10);
+	struct iovec vectors[2];
+	char tmp[32];
+
+	assertEquals(16, ring->capacity(), "Test capacity rounded up");
+	assertEquals(10, ring->write("0123456789", 10), "Test write");
+	assertEquals(6, ring->available(), "Test available");
+
+	memset(tmp, 0, sizeof(tmp));
+	assertEquals(8, ring->read(tmp, 8), "Test read");
+	assertEquals("01234567", tmp, "Test read data");
+
+	//Free space now wraps around the end.
+	assertEquals(2, ring->getWriteVectors(vectors), "Test write vectors wrap");
+	assertEquals(6, vectors[0].iov_len, "Test write vector 1 size");
+	assertEquals(8, vectors[1].iov_len, "Test write vector 2 size");
+
+	memcpy(vectors[0].iov_base, "abcdef", 6);
+	memcpy(vectors[1].iov_base, "ghij", 4);
+	ring->commitWrite(10);
+
+	assertEquals(12, ring->size(), "Test commit write");
+	assertEquals(2, ring->getReadVectors(vectors), "Test read vectors wrap");
+	assertEquals(8, vectors[0].iov_len, "Test read vector 1 size");
+	assertEquals(4, vectors[1].iov_len, "Test read vector 2 size");
+
+	memset(tmp, 0, sizeof(tmp));
+	assertEquals(12, ring->read(tmp, sizeof(tmp)), "Test read wrap");
+	assertEquals("89abcdefghij", tmp, "Test read wrap data");
+	assertEquals(0, ring->getReadVectors(vectors), "Test read vectors empty");
+
+	delete ring;
+}
+
+void testFull()
+{
+	RingBuffer *ring = new RingBuffer(8);
+	struct iovec vectors[2];
+	char tmp[32];
+
+	assertEquals(8, ring->write("0123456789", 10), "Test write full");
+	assertEquals(0, ring->getWriteVectors(vectors), "Test write vectors full");
+
+	ring->consume(3);
+	assertEquals(3, ring->available(), "Test consume");
+
+	assertEquals(-1, ring->resize(4), "Test shrink below size");
+	assertEquals(0, ring->resize(32), "Test grow");
+	assertEquals(5, ring->size(), "Test grow keeps data");
+
+	memset(tmp, 0, sizeof(tmp));
+	ring->read(tmp, sizeof(tmp));
+	assertEquals("34567", tmp, "Test grow data");
+
+	ring->write("abc", 3);
+	ring->clear();
+	assertEquals(0, ring->size(), "Test clear");
+
+	delete ring;
+}
+
+int main()
+{
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	testWrap();
+	testFull();
+
+	return 0;
+}
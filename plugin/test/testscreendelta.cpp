@@ -0,0 +1,236 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+#include "test/unittest.hpp"
+
+#include "terminal/screendelta.hpp"
+#include "terminal/vtterminalstate.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+/**
+ * Compares the screens of two states by the whole screen deltas made from them.
+ */
+bool isSameScreen(TerminalState *state, TerminalState *replica)
+{
+	ScreenDeltaEncoder expected;
+	ScreenDeltaEncoder actual;
+	std::vector<char> expectedDelta;
+	std::vector<char> actualDelta;
+
+	expected.encode(state, expectedDelta);
+	actual.encode(replica, actualDelta);
+
+	return (expectedDelta == actualDelta);
+}
+
+VTTerminalState *createState(int nWidth, int nHeight)
+{
+	VTTerminalState *state = new VTTerminalState();
+
+	state->setDisplayScreenSize(nWidth, nHeight);
+	state->addTerminalModeFlags(TS_TM_AUTO_WRAP);
+
+	return state;
+}
+
+void write(VTTerminalState *state, const char *sData)
+{
+	state->insertString(sData, strlen(sData), NULL);
+}
+
+bool hasOp(std::vector<char> &delta, int nOp)
+{
+	return (!delta.empty() && delta[0] == nOp);
+}
+
+void testFullScreen()
+{
+	VTTerminalState *state = createState(20, 5);
+	VTTerminalState *replica = createState(20, 5);
+	ScreenDeltaEncoder encoder;
+	std::vector<char> delta;
+
+	write(state, "plain \x1B[1;31mbold red\x1B[0m\r\n\x1B[44mblue\x1B[0m back\x1B[3;5Hmoved");
+
+	assertEquals(0, encoder.encode(state, delta), "Test encode full screen");
+	assertEquals(1, hasOp(delta, SD_OP_SIZE), "Test full screen starts with size");
+	assertEquals(0, ScreenDeltaDecoder::apply(replica, &delta[0], delta.size()), "Test apply full screen");
+	assertEquals(1, isSameScreen(state, replica), "Test full screen replica");
+	assertEquals(3, replica->getCursorLocation().getY(), "Test full screen cursor line");
+	assertEquals(10, replica->getCursorLocation().getX(), "Test full screen cursor column");
+
+	assertEquals(0, encoder.encode(state, delta), "Test encode unchanged");
+	assertEquals(0, delta.size(), "Test unchanged screen has empty delta");
+
+	write(state, "\x1B[1;1H\x1B[32mX");
+	encoder.encode(state, delta);
+	assertEquals(1, hasOp(delta, SD_OP_LINE), "Test changed line");
+	assertEquals(1, delta.size() < 40, "Test changed line is small");
+	ScreenDeltaDecoder::apply(replica, &delta[0], delta.size());
+	assertEquals(1, isSameScreen(state, replica), "Test changed line replica");
+
+	write(state, "\x1B[2;2H");
+	encoder.encode(state, delta);
+	assertEquals(5, delta.size(), "Test cursor move only");
+	ScreenDeltaDecoder::apply(replica, &delta[0], delta.size());
+	assertEquals(1, isSameScreen(state, replica), "Test cursor move replica");
+
+	state->resizeDisplayScreen(30, 8);
+	encoder.encode(state, delta);
+	assertEquals(1, hasOp(delta, SD_OP_SIZE), "Test resize sends size");
+	ScreenDeltaDecoder::apply(replica, &delta[0], delta.size());
+	assertEquals(30, replica->getDisplayScreenSize().getX(), "Test resize replica width");
+	assertEquals(1, isSameScreen(state, replica), "Test resize replica");
+
+	delete state;
+	delete replica;
+}
+
+void testScroll()
+{
+	VTTerminalState *state = createState(40, 10);
+	VTTerminalState *replica = createState(40, 10);
+	ScreenDeltaEncoder encoder;
+	std::vector<char> delta;
+	char sLine[64];
+
+	for (int i = 0; i < 10; i++)
+	{
+		snprintf(sLine, sizeof(sLine), "\r\nline %d \x1B[7mreverse\x1B[0m", i);
+		write(state, sLine);
+	}
+
+	encoder.encode(state, delta);
+	size_t nFullSize = delta.size();
+	ScreenDeltaDecoder::apply(replica, &delta[0], delta.size());
+
+	write(state, "\r\nline 10\r\nline 11\r\nline 12");
+	encoder.encode(state, delta);
+	assertEquals(1, hasOp(delta, SD_OP_SCROLL), "Test scroll op");
+	assertEquals(1, delta.size() < nFullSize / 2, "Test scroll is smaller than the screen");
+	assertEquals(0, ScreenDeltaDecoder::apply(replica, &delta[0], delta.size()), "Test apply scroll");
+	assertEquals(1, isSameScreen(state, replica), "Test scroll replica");
+	assertEquals(3, replica->getBufferTopLineIndex(), "Test scrolled lines go to history");
+
+	//Scroll down within a region.
+	write(state, "\x1B[3;8r\x1B[3;1H\x1BM\x1BM");
+	encoder.encode(state, delta);
+	ScreenDeltaDecoder::apply(replica, &delta[0], delta.size());
+	assertEquals(1, isSameScreen(state, replica), "Test region scroll replica");
+
+	delete state;
+	delete replica;
+}
+
+/**
+ * Changes the screen in many ways between deltas, and checks that the replica keeps up.
+ * Only the screen at the time of each delta is sent, however much happened in between.
+ */
+void testRandom()
+{
+	static const char *sSequences[] = { "\r\n", "\x1B[1;31m", "\x1B[0m", "\x1B[44m", "\x1B[7m", "\x1B[2J",
+		"\x1B[K", "\x1B[5;3H", "\x1B[A", "\x1B[2;6r", "\x1B[r", "\x1BM", "\x1B[3P", "\x1B[2@", "\x1B[J" };
+	VTTerminalState *state = createState(50, 12);
+	VTTerminalState *replica = createState(50, 12);
+	ScreenDeltaEncoder encoder;
+	std::vector<char> delta;
+	int nNumSequences = sizeof(sSequences) / sizeof(sSequences[0]);
+	int nMismatches = 0;
+	size_t nDeltaBytes = 0;
+	size_t nOutputBytes = 0;
+
+	srand(1);
+
+	for (int i = 0; i < 500; i++)
+	{
+		int nNumWrites = 1 + rand() % 40;
+
+		for (int j = 0; j < nNumWrites; j++)
+		{
+			if (rand() % 3 == 0)
+			{
+				write(state, sSequences[rand() % nNumSequences]);
+				nOutputBytes += 3;
+			}
+			else
+			{
+				char sText[32];
+				int nSize = 1 + rand() % (sizeof(sText) - 1);
+
+				for (int k = 0; k < nSize; k++)
+				{
+					sText[k] = 'a' + rand() % 26;
+				}
+
+				state->insertString(sText, nSize, NULL);
+				nOutputBytes += nSize;
+			}
+		}
+
+		encoder.encode(state, delta);
+		nDeltaBytes += delta.size();
+
+		if (!delta.empty() && ScreenDeltaDecoder::apply(replica, &delta[0], delta.size()) != 0)
+		{
+			nMismatches++;
+		}
+
+		if (!isSameScreen(state, replica))
+		{
+			nMismatches++;
+		}
+	}
+
+	assertEquals(0, nMismatches, "Test random replica");
+
+	delete state;
+	delete replica;
+}
+
+void testInvalid()
+{
+	VTTerminalState *replica = createState(20, 5);
+	const char sBadOp[] = { 99 };
+	const char sBadLine[] = { SD_OP_LINE, 9, 0, 0, 0, 0, 0 };
+	const char sShort[] = { SD_OP_LINE, 1, 0, 50, 0, 'a' };
+
+	assertEquals(-1, ScreenDeltaDecoder::apply(replica, sBadOp, sizeof(sBadOp)), "Test invalid op");
+	assertEquals(-1, ScreenDeltaDecoder::apply(replica, sBadLine, sizeof(sBadLine)), "Test invalid line");
+	assertEquals(-1, ScreenDeltaDecoder::apply(replica, sShort, sizeof(sShort)), "Test truncated line");
+	assertEquals(-1, ScreenDeltaDecoder::apply(NULL, sBadOp, sizeof(sBadOp)), "Test no state");
+
+	delete replica;
+}
+
+int main()
+{
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	testFullScreen();
+	testScroll();
+	testRandom();
+	testInvalid();
+
+	return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+#include "test/unittest.hpp"
+
+#include "terminal/scrollbackindex.hpp"
+#include "terminal/scrollbacksearch.hpp"
+#include "terminal/vtterminalstate.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+class SearchResult : public ScrollbackSearchListener
+{
+public:
+	std::vector<int64_t> m_lines;
+	std::vector<int> m_columns;
+	int m_nNumMatches;
+	bool m_bCancelled;
+
+	SearchResult()
+	{
+		m_nNumMatches = -1;
+		m_bCancelled = false;
+	}
+
+	void searchMatch(int64_t nLineNumber, int nColumn, int nLength)
+	{
+		m_lines.push_back(nLineNumber);
+		m_columns.push_back(nColumn);
+	}
+
+	void searchDone(int nNumMatches, bool bCancelled)
+	{
+		m_nNumMatches = nNumMatches;
+		m_bCancelled = bCancelled;
+	}
+};
+
+void testIndex()
+{
+	ScrollbackIndex *index = new ScrollbackIndex();
+	std::vector<SILineRange_t> ranges;
+
+	index->addLine(0, "hello world", 11);
+	index->addLine(1, "Hello there", 11);
+	index->addLine(2, "goodbye", 7);
+	index->addLine(3, "say hello", 9);
+
+	assertEquals(0, index->findCandidates("hello", 5, ranges), "Test index find");
+	assertEquals(2, ranges.size(), "Test index find ranges");
+	assertEquals(0, ranges[0].nStart, "Test index find range start");
+	assertEquals(2, ranges[0].nEnd, "Test index find range end");
+	assertEquals(3, ranges[1].nStart, "Test index find range start (2)");
+	assertEquals(4, ranges[1].nEnd, "Test index find range end (2)");
+
+	assertEquals(0, index->findCandidates("xyz", 3, ranges), "Test index find missing");
+	assertEquals(0, ranges.size(), "Test index find missing ranges");
+	assertEquals(-1, index->findCandidates("he", 2, ranges), "Test index find short literal");
+
+	index->removeLinesBefore(1);
+	index->findCandidates("hello", 5, ranges);
+	assertEquals(2, ranges.size(), "Test index remove before");
+	assertEquals(1, ranges[0].nStart, "Test index remove before range start");
+
+	index->removeLinesFrom(3);
+	index->addLine(3, "nothing", 7);
+	index->findCandidates("hello", 5, ranges);
+	assertEquals(1, ranges.size(), "Test index remove from");
+	assertEquals(2, ranges[0].nEnd, "Test index remove from range end");
+
+	//Line numbers of a long running session do not fit in 32 bits.
+	int64_t nLine = ((int64_t)1 << 32) + 5;
+
+	index->clear(nLine);
+	index->addLine(nLine, "hello again", 11);
+	index->addLine(nLine + 1, "goodbye", 7);
+	index->findCandidates("hello", 5, ranges);
+	assertEquals(1, ranges.size(), "Test index large line numbers");
+	assertEquals(1, ranges[0].nStart == nLine && ranges[0].nEnd == nLine + 1, "Test index large line number range");
+
+	delete index;
+}
+
+void testRequiredLiteral()
+{
+	char sLiteral[32];
+	int nSize;
+
+	memset(sLiteral, 0, sizeof(sLiteral));
+	nSize = ScrollbackSearch::getRequiredLiteral("error: [0-9]+ failures", SS_REGEX, sLiteral, sizeof(sLiteral));
+	sLiteral[nSize] = '\0';
+	assertEquals(" failures", sLiteral, "Test required literal");
+
+	nSize = ScrollbackSearch::getRequiredLiteral("abcdx?yz", SS_REGEX, sLiteral, sizeof(sLiteral));
+	sLiteral[nSize] = '\0';
+	assertEquals("abcd", sLiteral, "Test required literal optional");
+
+	nSize = ScrollbackSearch::getRequiredLiteral("foo|barbaz", SS_REGEX, sLiteral, sizeof(sLiteral));
+	assertEquals(0, nSize, "Test required literal alternatives");
+
+	nSize = ScrollbackSearch::getRequiredLiteral("a.b(cdefgh)?", SS_REGEX, sLiteral, sizeof(sLiteral));
+	assertEquals(1, nSize, "Test required literal group");
+}
+
+void testSearch(bool bIndex)
+{
+	VTTerminalState *state = new VTTerminalState();
+	SearchResult result;
+	ScrollbackSearch *search = new ScrollbackSearch(state, &result);
+	char sLine[32];
+
+	state->setDisplayScreenSize(20, 5);
+	state->setNumBufferLines(100);
+	state->enableSearchIndex(bIndex);
+
+	for (int i = 0; i < 150; i++)
+	{
+		sprintf(sLine, "line %d%s\r\n", i, (i % 10 == 3) ? " Match" : "");
+		state->insertString(sLine, NULL);
+	}
+
+	assertEquals(51, state->getFirstLineNumber(), "Test search first line number");
+
+	if (bIndex)
+	{
+		std::vector<SILineRange_t> ranges;
+
+		state->getSearchIndex()->findCandidates("match", 5, ranges);
+		assertEquals(10, ranges.size(), "Test search index candidates");
+		assertEquals(53, ranges[0].nStart, "Test search index first candidate");
+	}
+
+	assertEquals(0, search->start("match", SS_LITERAL | SS_IGNORE_CASE), "Test search start");
+	search->wait();
+
+	assertEquals(10, result.m_nNumMatches, "Test search matches");
+	assertEquals(10, result.m_lines.size(), "Test search reported matches");
+	assertEquals(0, result.m_bCancelled, "Test search not cancelled");
+	assertEquals(143, result.m_lines[0], "Test search newest match first");
+	assertEquals(53, result.m_lines[9], "Test search oldest match");
+	assertEquals(9, result.m_columns[0], "Test search match column");
+
+	result.m_lines.clear();
+	result.m_columns.clear();
+
+	assertEquals(0, search->start("^line 1[0-9]3 ", SS_REGEX), "Test search regex start");
+	search->wait();
+	assertEquals(5, result.m_nNumMatches, "Test search regex matches");
+
+	assertEquals(0, search->start("Match", SS_LITERAL), "Test search case sensitive start");
+	search->wait();
+	assertEquals(10, result.m_nNumMatches, "Test search case sensitive matches");
+
+	assertEquals(0, search->start("match", SS_LITERAL), "Test search case sensitive start (2)");
+	search->wait();
+	assertEquals(0, result.m_nNumMatches, "Test search case sensitive matches (2)");
+
+	assertEquals(-1, search->start("(", SS_REGEX), "Test search invalid regex");
+
+	delete search;
+	delete state;
+}
+
+/**
+ * A reverse index on the first row without history inserts a line before the first line.
+ */
+void testSearchReverseIndex(bool bIndex)
+{
+	VTTerminalState *state = new VTTerminalState();
+	SearchResult result;
+	ScrollbackSearch *search = new ScrollbackSearch(state, &result);
+	char sLine[32];
+	char sText[32];
+	int nSize;
+
+	state->setDisplayScreenSize(20, 5);
+	state->setNumBufferLines(100);
+	state->enableSearchIndex(bIndex);
+
+	state->insertString("first\x1b[H", NULL);
+	state->moveCursorUp(1, true);
+	state->insertString("reversed Match\x1b[5H", NULL);
+
+	assertEquals(-1, state->getFirstLineNumber(), "Test reverse index first line number");
+
+	for (int i = 0; i < 10; i++)
+	{
+		sprintf(sLine, "\r\nline %d", i);
+		state->insertString(sLine, NULL);
+	}
+
+	assertEquals(0, search->start("match", SS_LITERAL | SS_IGNORE_CASE), "Test reverse index search start");
+	search->wait();
+
+	assertEquals(1, result.m_nNumMatches, "Test reverse index search matches");
+	assertEquals(-1, result.m_lines[0], "Test reverse index search line");
+
+	nSize = state->getLineText(result.m_lines[0], sText, sizeof(sText) - 1);
+	sText[(nSize < 0) ? 0 : nSize] = '\0';
+	assertEquals("reversed Match", sText, "Test reverse index line text");
+
+	nSize = state->getLineText(0, sText, sizeof(sText) - 1);
+	sText[(nSize < 0) ? 0 : nSize] = '\0';
+	assertEquals("first", sText, "Test reverse index next line text");
+
+	delete search;
+	delete state;
+}
+
+int main()
+{
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	testIndex();
+	testRequiredLiteral();
+	testSearch(true);
+	testSearch(false);
+	testSearchReverseIndex(true);
+	testSearchReverseIndex(false);
+
+	return 0;
+}
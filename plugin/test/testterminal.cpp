@@ -0,0 +1,215 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/logger.hpp"
+#include "test/unittest.hpp"
+
+#include "terminal/session.hpp"
+#include "terminal/sessionmanager.hpp"
+#include "terminal/terminal.hpp"
+#include "terminal/vtterminalstate.hpp"
+
+#include <pthread.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * Collects the output of the terminal.
+ */
+class OutputTerminal : public ExtTerminal
+{
+private:
+	std::string m_output;
+	pthread_mutex_t m_lock;
+
+public:
+	volatile int m_nExitStatus;
+
+	OutputTerminal()
+	{
+		m_nExitStatus = -1;
+		pthread_mutex_init(&m_lock, NULL);
+		setReady(true);
+	}
+
+	~OutputTerminal()
+	{
+		pthread_mutex_destroy(&m_lock);
+	}
+
+	void insertData(const char *data, size_t size)
+	{
+		pthread_mutex_lock(&m_lock);
+		m_output.append(data, size);
+		pthread_mutex_unlock(&m_lock);
+	}
+
+	void childExited(int nStatus)
+	{
+		m_nExitStatus = nStatus;
+	}
+
+	std::string getOutput()
+	{
+		std::string output;
+
+		pthread_mutex_lock(&m_lock);
+		output = m_output;
+		pthread_mutex_unlock(&m_lock);
+
+		return output;
+	}
+};
+
+/**
+ * Waits up to ten seconds for the output to start with the given text.
+ */
+bool waitForOutput(OutputTerminal *output, const char *sText)
+{
+	for (int i = 0; i < 10000; i++)
+	{
+		if (output->getOutput().compare(0, strlen(sText), sText) == 0)
+		{
+			return true;
+		}
+
+		usleep(1000);
+	}
+
+	return false;
+}
+
+/**
+ * Pastes into a child that shows exactly the bytes it reads, with escapes made visible.
+ */
+void testBracketedPaste()
+{
+	SessionManager *manager = new SessionManager();
+	Terminal *terminal = new Terminal();
+	OutputTerminal *output = new OutputTerminal();
+	const char *paste = "echo safe\x1B[201~echo injected\n";
+	const char *expected = "ready\n^[[200~echo safe[201~echo injected\n^[[201~";
+	char sCommand[128];
+
+	//The child reads the markers and the paste without its one escape character.
+	sprintf(sCommand, "stty raw -echo; echo ready; head -c %d | cat -v", (int)(12 + strlen(paste) - 1));
+
+	const char *command[] = { "/bin/sh", "-c", sCommand, NULL };
+
+	terminal->setExtTerminal(output);
+	terminal->setWindowSize(80, 24);
+	terminal->setCommand(command);
+
+	assertEquals(0, manager->start(), "Test paste start manager");
+	assertEquals(0, terminal->start(), "Test paste start terminal");
+	assertEquals(0, manager->addTerminal(terminal), "Test paste add terminal");
+	assertEquals(1, waitForOutput(output, "ready\n"), "Test paste child ready");
+
+	terminal->pasteData(paste, strlen(paste), true);
+
+	assertEquals(1, waitForOutput(output, expected), "Test paste child output");
+	assertEquals(expected, output->getOutput().c_str(), "Test bracketed paste drops escapes");
+
+	delete terminal;
+	delete output;
+	delete manager;
+}
+
+/**
+ * The external terminal is told the exit status once the child exited.
+ */
+void testChildExited()
+{
+	SessionManager *manager = new SessionManager();
+	Terminal *terminal = new Terminal();
+	OutputTerminal *output = new OutputTerminal();
+	const char *command[] = { "/bin/sh", "-c", "echo bye; exit 3", NULL };
+
+	terminal->setExtTerminal(output);
+	terminal->setWindowSize(80, 24);
+	terminal->setCommand(command);
+
+	assertEquals(0, manager->start(), "Test exit start manager");
+	assertEquals(0, terminal->start(), "Test exit start terminal");
+	assertEquals(0, manager->addTerminal(terminal), "Test exit add terminal");
+
+	for (int i = 0; i < 10000 && output->m_nExitStatus == -1; i++)
+	{
+		usleep(1000);
+	}
+
+	assertEquals(1, WIFEXITED(output->m_nExitStatus), "Test exit status exited");
+	assertEquals(3, WEXITSTATUS(output->m_nExitStatus), "Test exit status code");
+	assertEquals("bye\r\n", output->getOutput().c_str(), "Test exit output before exit");
+
+	delete terminal;
+	delete output;
+	delete manager;
+}
+
+/**
+ * Children that ignore the hangup are all given the same moment to exit, not one each.
+ */
+void testStopChildren()
+{
+	SessionManager *manager = new SessionManager();
+	const char *command[] = { "/bin/sh", "-c", "trap '' HUP; echo ready; sleep 10", NULL };
+	std::vector<Session *> sessions;
+	struct timeval start, end;
+
+	assertEquals(0, manager->start(), "Test stop children start manager");
+
+	for (int i = 0; i < 4; i++)
+	{
+		sessions.push_back(manager->createSession(80, 24, command));
+		assertEquals(1, sessions.back() != NULL, "Test stop children create session");
+	}
+
+	//Once the cursor moved past "ready", the child ignores the hangup.
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 10000 && sessions[i]->getState()->getCursorLocation().getY() < 2; j++)
+		{
+			usleep(1000);
+		}
+	}
+
+	gettimeofday(&start, NULL);
+	delete manager;
+	gettimeofday(&end, NULL);
+
+	int nMsec = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000;
+
+	assertEquals(1, nMsec < 300, "Test stop children share the wait");
+}
+
+int main()
+{
+	Logger::getInstance()->setLogLevel(Logger::ERROR);
+
+	testBracketedPaste();
+	testChildExited();
+	testStopChildren();
+
+	return 0;
+}
@@ -1,39 +1,39 @@
-/**
- * This file is part of SDLTerminal.
- * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
- *
- * SDLTerminal is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * SDLTerminal is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
-
- * You should have received a copy of the GNU General Public License
- * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef POINT_HPP__
-#define POINT_HPP__
-
-class Point
-{
-private:
-	int m_nX;
-	int m_nY;
-
-public:
-	Point();
-	Point(int nX, int nY);
-
-	int getX() const;
-	int getY() const;
-	void setX(int nX);
-	void setY(int nY);
-	void setLocation(int nX, int nY);
-};
-
-#endif
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POINT_HPP__
+#define POINT_HPP__
+
+class Point
+{
+private:
+	int m_nX;
+	int m_nY;
+
+public:
+	Point();
+	Point(int nX, int nY);
+
+	int getX() const;
+	int getY() const;
+	void setX(int nX);
+	void setY(int nY);
+	void setLocation(int nX, int nY);
+};
+
+#endif
@@ -0,0 +1,242 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ringbuffer.hpp"
+
+RingBuffer::RingBuffer(size_t capacity)
+{
+	m_buffer = NULL;
+	m_capacity = 0;
+	m_readIndex = 0;
+	m_writeIndex = 0;
+
+	resize(capacity);
+}
+
+RingBuffer::~RingBuffer()
+{
+	free(m_buffer);
+}
+
+/**
+ * Changes the capacity, rounded up to a power of two. Data in the ring is kept if it fits.
+ * Returns -1 if an error occurs. Returns 0 if success.
+ */
+int RingBuffer::resize(size_t capacity)
+{
+	size_t newCapacity = 1;
+	char *tmp;
+
+	while (newCapacity < capacity)
+	{
+		newCapacity <<= 1;
+	}
+
+	if (newCapacity == m_capacity)
+	{
+		return 0;
+	}
+
+	if (newCapacity < size())
+	{
+		return -1;
+	}
+
+	tmp = (char *)malloc(newCapacity);
+
+	if (tmp == NULL)
+	{
+		return -1;
+	}
+
+	size_t nSize = read(tmp, size());
+
+	free(m_buffer);
+
+	m_buffer = tmp;
+	m_capacity = newCapacity;
+	m_readIndex = 0;
+	m_writeIndex = nSize;
+
+	return 0;
+}
+
+/**
+ * Gets the number of bytes waiting to be read.
+ */
+size_t RingBuffer::size() const
+{
+	return m_writeIndex - m_readIndex;
+}
+
+size_t RingBuffer::capacity() const
+{
+	return m_capacity;
+}
+
+/**
+ * Gets the number of bytes that can be written.
+ */
+size_t RingBuffer::available() const
+{
+	return m_capacity - size();
+}
+
+/**
+ * Gets the free space as up to two regions to write into, in order.
+ * Returns the number of regions.
+ */
+int RingBuffer::getWriteVectors(struct iovec *vectors)
+{
+	size_t nAvailable = available();
+	size_t nStart = m_writeIndex & (m_capacity - 1);
+	size_t nFirstSize = m_capacity - nStart;
+
+	//The reader is done with the space before its index is seen.
+	__sync_synchronize();
+
+	if (nAvailable == 0 || m_buffer == NULL)
+	{
+		return 0;
+	}
+
+	if (nFirstSize >= nAvailable)
+	{
+		vectors[0].iov_base = m_buffer + nStart;
+		vectors[0].iov_len = nAvailable;
+		return 1;
+	}
+
+	vectors[0].iov_base = m_buffer + nStart;
+	vectors[0].iov_len = nFirstSize;
+	vectors[1].iov_base = m_buffer;
+	vectors[1].iov_len = nAvailable - nFirstSize;
+
+	return 2;
+}
+
+/**
+ * Marks bytes written into the regions from getWriteVectors() as ready to read.
+ */
+void RingBuffer::commitWrite(size_t size)
+{
+	size_t nAvailable = available();
+
+	//Publish the data before the index that makes it visible.
+	__sync_synchronize();
+
+	m_writeIndex += (size > nAvailable) ? nAvailable : size;
+}
+
+/**
+ * Gets the data waiting to be read as up to two regions, in order.
+ * Returns the number of regions.
+ */
+int RingBuffer::getReadVectors(struct iovec *vectors)
+{
+	size_t nSize = size();
+	size_t nStart = m_readIndex & (m_capacity - 1);
+	size_t nFirstSize = m_capacity - nStart;
+
+	//The data is read only after its index is seen.
+	__sync_synchronize();
+
+	if (nSize == 0)
+	{
+		return 0;
+	}
+
+	if (nFirstSize >= nSize)
+	{
+		vectors[0].iov_base = m_buffer + nStart;
+		vectors[0].iov_len = nSize;
+		return 1;
+	}
+
+	vectors[0].iov_base = m_buffer + nStart;
+	vectors[0].iov_len = nFirstSize;
+	vectors[1].iov_base = m_buffer;
+	vectors[1].iov_len = nSize - nFirstSize;
+
+	return 2;
+}
+
+/**
+ * Discards bytes from the front of the ring.
+ */
+void RingBuffer::consume(size_t size)
+{
+	size_t nSize = this->size();
+
+	//Finish reading the data before handing its space back.
+	__sync_synchronize();
+
+	m_readIndex += (size > nSize) ? nSize : size;
+}
+
+/**
+ * Copies data into the ring. Returns the number of bytes written.
+ */
+size_t RingBuffer::write(const char *data, size_t size)
+{
+	struct iovec vectors[2];
+	int nNumVectors = getWriteVectors(vectors);
+	size_t nWritten = 0;
+
+	for (int i = 0; i < nNumVectors && nWritten < size; i++)
+	{
+		size_t nSize = (vectors[i].iov_len < (size - nWritten)) ? vectors[i].iov_len : (size - nWritten);
+
+		memcpy(vectors[i].iov_base, data + nWritten, nSize);
+		nWritten += nSize;
+	}
+
+	commitWrite(nWritten);
+
+	return nWritten;
+}
+
+/**
+ * Copies data out of the ring and consumes it. Returns the number of bytes read.
+ */
+size_t RingBuffer::read(char *dest, size_t size)
+{
+	struct iovec vectors[2];
+	int nNumVectors = getReadVectors(vectors);
+	size_t nRead = 0;
+
+	for (int i = 0; i < nNumVectors && nRead < size; i++)
+	{
+		size_t nSize = (vectors[i].iov_len < (size - nRead)) ? vectors[i].iov_len : (size - nRead);
+
+		memcpy(dest + nRead, vectors[i].iov_base, nSize);
+		nRead += nSize;
+	}
+
+	consume(nRead);
+
+	return nRead;
+}
+
+void RingBuffer::clear()
+{
+	m_readIndex = m_writeIndex;
+}
@@ -0,0 +1,59 @@
+/**
+ * This file is part of SDLTerminal.
+ * Copyright (C) 2011 Vincent Ho <www.whimsicalvee.com>
+ *
+ * SDLTerminal is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SDLTerminal is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with SDLTerminal.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RINGBUFFER_HPP__
+#define RINGBUFFER_HPP__
+
+#include <stdio.h>
+#include <sys/uio.h>
+
+/**
+ * A fixed capacity byte ring. Free and used space are exposed as at most two
+ * contiguous regions, so the ring can be filled with readv and drained without
+ * intermediate copies.
+ * One thread may write while another reads, without locking. Resizing and clearing
+ * must only be done while the other side is idle.
+ */
+class RingBuffer
+{
+private:
+	char *m_buffer;
+	size_t m_capacity; //Always a power of two.
+	volatile size_t m_readIndex; //Total bytes consumed. Wraps around. Only changed by the reader.
+	volatile size_t m_writeIndex; //Total bytes written. Wraps around. Only changed by the writer.
+
+public:
+	RingBuffer(size_t capacity);
+	~RingBuffer();
+
+	int resize(size_t capacity);
+	size_t size() const;
+	size_t capacity() const;
+	size_t available() const;
+
+	int getWriteVectors(struct iovec *vectors);
+	void commitWrite(size_t size);
+	int getReadVectors(struct iovec *vectors);
+	void consume(size_t size);
+
+	size_t write(const char *data, size_t size);
+	size_t read(char *dest, size_t size);
+	void clear();
+};
+
+#endif